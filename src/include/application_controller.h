@@ -5,17 +5,34 @@
 
 #pragma once
 
+#include "detection_lib_version.h"
 #include "vision/inference_engine.h"
+#include "vision/detection_input.h"
+#include "vision/video_file_decoder.h"
 #include "voice/inference_engine_voice.h"
+#include "voice/audio_buffer_pool.h"
+#include "voice/artifact_writer.h"
+#include "voice/capture_backpressure.h"
+#include "voice/multi_stream.h"
 #include "database.h"
+#include "media_demux.h"
+#include "scan_queue.h"
+#include "segment_fusion.h"
 #include "utils/config_reader.h"
 #include "utils/keygen_license_manager.h"
+#include "utils/thread_policy.h"
+#include "utils/worker_pool.h"
 
 #include "readerwriterqueue/readerwriterqueue.h"
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <variant>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 
 namespace edf {
 
@@ -102,6 +119,15 @@ class ApplicationController {
         float score;
     };
 
+    /**
+     * @brief Score of one stream in per-channel analysis (`voicePerChannelAnalysis`).
+     */
+    struct VoiceStreamScore {
+        size_t stream;        ///< Capture channel (or mic/loopback stream) index
+        float score;          ///< Model score of the stream's latest window
+        float fakeProportion; ///< Fraction of the stream's recent windows above the probability threshold
+    };
+
     /// Uploads all saved face detection artifacts to S3.
     void saveFacesToS3();
 
@@ -151,7 +177,8 @@ class ApplicationController {
     enum class VoiceClassification { Deepfake, Real, Analyzing, Invalid, None };
 
     /// Union of possible updates from voice detection.
-    using VoiceDetectionUpdate = std::variant<VoiceClassification, VoiceGraphScore, ResultNotification>;
+    using VoiceDetectionUpdate =
+        std::variant<VoiceClassification, VoiceGraphScore, ResultNotification, VoiceStreamScore>;
 
     /**
      * Runs voice-based deepfake detection.
@@ -163,6 +190,12 @@ class ApplicationController {
      * @param captureDurationSecs Duration of each audio capture interval.
      * @param captureQueue Queue holding audio capture data.
      * @param calback Callback to receive updates.
+     * @param bufferPool When given, scored buffers are handed back to it for the capture thread to reuse.
+     * @param backpressure When given, applied to the queue as chunks are taken from it; the capture side must enqueue
+     *                     through the same instance. Live capture configures it with `configureVoiceCapture`.
+     * @param endOfInput For finite sources (files, pipes): the producer sets it after enqueueing its last chunk. Once
+     *                   it is set and the queue is drained, the last chunk is scored as the final window and the
+     *                   session ends as if `sessionDurationSecs` had elapsed. Live capture leaves it null.
      */
     void runVoiceDetection(std::atomic_bool& run,
                            AudioMode mode,
@@ -170,7 +203,10 @@ class ApplicationController {
                            size_t sessionDurationSecs,
                            int captureDurationSecs,
                            moodycamel::ReaderWriterQueue<voice::AudioBuffer>& captureQueue,
-                           std::function<void(const VoiceDetectionUpdate&)> callback);
+                           std::function<void(const VoiceDetectionUpdate&)> callback,
+                           voice::AudioBufferPool* bufferPool = nullptr,
+                           voice::CaptureBackpressure* backpressure = nullptr,
+                           const std::atomic_bool* endOfInput = nullptr);
 
     /**
      * @brief Possible face classification outcomes.
@@ -200,11 +236,130 @@ class ApplicationController {
                            std::function<std::vector<cv::Mat>()> screenCapture,
                            std::function<void(const FaceDetectionUpdate&)> callback);
 
+    /**
+     * @brief Progress of an offline file scan.
+     */
+    struct FileScanProgress {
+        size_t framesAnalysed = 0;
+        long long totalFrames = 0;   ///< Container estimate of the frames to analyse, 0 when it reports no count
+        double framesPerSec   = 0.0; ///< Frames analysed per wall-clock second since the scan started
+        long long resumeFrame = 0;   ///< Checkpoint: every frame before this one has been analysed
+    };
+
+    /// Union of possible updates from a file scan.
+    using FileScanUpdate =
+        std::variant<std::vector<ScreenshotFace>, FaceClassification, ResultNotification, FileScanProgress>;
+
+    /**
+     * Scans a recorded video file for deepfaked faces as fast as the machine allows.
+     *
+     * Frames are decoded on `videoFileDecodeThreads` threads (see vision/video_file_decoder.h) and run through the
+     * same face detection and classification as `runVideoDetection`, with the thresholds of the mode the environment
+     * was set up for (normally `VideoMode::WebSurfing`). Faces are recorded in the `db::Face` table and results
+     * directory like a live session, with `timestamp` the wall-clock detection time as for live rows (retention and
+     * upload rely on it) and `source_file`/`media_position_ms`/`media_frame` locating the frame in the recording.
+     * Resuming at `firstFrame` first removes the file's rows from that frame on (`Database::remove_file_faces_from`):
+     * the parallel decoder's checkpoint is conservative, so frames of later ranges are analysed again and must not be
+     * recorded twice.
+     * `FileScanProgress` is reported about once per second and once at the end.
+     *
+     * @param run Atomic boolean to stop the scan early.
+     * @param videoFile File to scan; anything the OpenCV FFmpeg backend can open.
+     * @param isBackgroundRun Indicates whether the scan is happening in background (only used to annotate results)
+     * @param callback Callback to receive updates.
+     * @param firstFrame Resumes an interrupted scan from its `FileScanProgress::resumeFrame`.
+     * @return true if the whole file was scanned, false if `run` was cleared first.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    bool runFileDetection(std::atomic_bool& run,
+                          const std::filesystem::path& videoFile,
+                          bool isBackgroundRun,
+                          std::function<void(const FileScanUpdate&)> callback,
+                          long long firstFrame = 0);
+
+    /**
+     * Scans every video file under a directory tree, resuming across restarts.
+     *
+     * Files are registered as `db::ScanJob` rows in the results database (see scan_queue.h) and scanned with
+     * `runFileDetection`, `videoScanConcurrentFiles` at a time; detection itself is shared and serialised between
+     * them. Finished and duplicate files are skipped, and interrupted files continue from their last checkpoint.
+     *
+     * @param run Atomic boolean to stop the scan; unfinished files stay queued for the next call.
+     * @param root Directory to scan recursively.
+     * @param isBackgroundRun Indicates whether the scan is happening in background (only used to annotate results)
+     * @param callback Callback to receive the updates of every file.
+     * @return Counts of the files queued, resumed, skipped, finished and failed.
+     */
+    DirectoryScanQueue::Stats runDirectoryScan(std::atomic_bool& run,
+                                               const std::filesystem::path& root,
+                                               bool isBackgroundRun,
+                                               std::function<void(const FileScanUpdate&)> callback);
+
+    /**
+     * @brief A track of a media scan that could not be analysed, or stopped decoding before the end of the file.
+     */
+    struct MediaTrackProblem {
+        std::string track;  ///< "audio" or "video"
+        std::string reason; ///< `MediaDemuxer::audioProblem` or `videoProblem`
+    };
+
+    /// Union of possible updates from a synchronised audio and video scan.
+    using MediaScanUpdate = std::variant<std::vector<ScreenshotFace>,
+                                         FaceClassification,
+                                         VoiceClassification,
+                                         FusedSegment,
+                                         ResultNotification,
+                                         FileScanProgress,
+                                         MediaTrackProblem>;
+
+    /**
+     * Analyses the audio and video tracks of a media file together, in one pass.
+     *
+     * A `MediaDemuxer` (see media_demux.h) decodes both tracks concurrently. Audio chunks run through the voice engine
+     * set up by `setupVoiceInferenceEnv` on a voice thread while frames run through face detection on the calling
+     * thread, as in `runFileDetection`. Both report into a `SegmentFusion` on the file's presentation timeline, and
+     * every `mediaSegmentMs` segment is reported as a `FusedSegment` once both modalities have passed it. Faces and
+     * flagged voice windows are recorded as in the single-modality scans. A file without one of the tracks is
+     * analysed with the other alone, and a `MediaTrackProblem` says why the track is missing, so a client can tell a
+     * silent file from an OpenCV build that cannot decode audio (on Linux audio needs OpenCV's GStreamer backend). A
+     * track that stops decoding early is reported the same way once the scan ends.
+     *
+     * @param run Atomic boolean to stop the scan early.
+     * @param mediaFile File to scan.
+     * @param isBackgroundRun Indicates whether the scan is happening in background (only used to annotate results)
+     * @param callback Callback to receive updates; called from the voice thread too, so it must be thread safe.
+     * @return true if both tracks were scanned to the end, false if `run` was cleared first.
+     * @throws std::runtime_error if the file has no readable track.
+     */
+    bool runMediaDetection(std::atomic_bool& run,
+                           const std::filesystem::path& mediaFile,
+                           bool isBackgroundRun,
+                           std::function<void(const MediaScanUpdate&)> callback);
+
     /**
      * Get the path to the local results directory.
      */
     const std::filesystem::path& resultsDir() const { return resultsRoot_; }
 
+    /**
+     * Capture chunk length for the audio fed to `runVoiceDetection` ([voice] voiceCaptureChunkMs); zero captures
+     * whole `captureDurationSecs` windows.
+     */
+    std::chrono::milliseconds voiceCaptureChunk() const {
+        return std::chrono::milliseconds(applicationConfig_.voiceCaptureChunkMs);
+    }
+
+    /**
+     * Applies the capture queue settings from [voice] (`voiceCaptureOverflowPolicy`, `voiceCaptureMaxQueueDepth`,
+     * `voiceCaptureCoalesceMs`) to a live capture channel's backpressure.
+     */
+    void configureVoiceCapture(voice::CaptureBackpressure& backpressure) const {
+        const char* policy = applicationConfig_.voiceCaptureOverflowPolicy;
+        backpressure.configure(voice::overflowPolicyFromString(policy ? policy : ""),
+                               static_cast<size_t>(std::max(applicationConfig_.voiceCaptureMaxQueueDepth, 1)),
+                               std::chrono::milliseconds(applicationConfig_.voiceCaptureCoalesceMs));
+    }
+
   private:
     // Voice stuff
     std::string voiceModelIdentifier_;
@@ -220,17 +375,38 @@ class ApplicationController {
     VoiceDetectionState
     doVoiceDetection(std::atomic_bool&, moodycamel::ReaderWriterQueue<voice::AudioBuffer>&, float, bool);
 
+    // Chunks drained from the capture queue when it has fallen behind, scored with one batched inference
+    std::vector<voice::AudioBuffer> voiceBacklog_;
+
+    // Per-channel analysis: one window/score state per capture channel, prepared on voiceWorkers_ and scored in one
+    // batch on the shared voice session; unset when the capture is analysed as one downmixed signal
+    std::unique_ptr<utils::WorkerPool> voiceWorkers_;
+    std::optional<voice::MultiStreamVoiceAnalyzer> voiceStreams_;
+
+    // Return channel of the current runVoiceDetection call, nullptr when buffers are simply freed
+    voice::AudioBufferPool* voiceBufferPool_ = nullptr;
+
+    // Overflow policy of the current runVoiceDetection call; doVoiceDetection dequeues through it when set
+    voice::CaptureBackpressure* voiceBackpressure_ = nullptr;
+
     std::string videoModelIdentifier_;
 
+    // Held around detection and classification of a frame, which runDirectoryScan shares between concurrent files
+    std::mutex fileScanInferenceMutex_;
+
     vision::InferenceEngine inferenceEngine_;
+    std::vector<vision::DetectionInput> detectionInputs_; ///< One reusable detector input per captured screen
 
     void prepareModels(const std::string& dirPath);
 
     const std::filesystem::path resultsRoot_;
     db::Database resultsDatabase_;
+    // Declared after the database it records into, so queued artifacts are stored before the database closes
+    std::unique_ptr<voice::VoiceArtifactWriter> voiceArtifactWriter_;
     std::unique_ptr<edf::license_manager::KeygenLicenseManager> keygenLicenseManager_;
     std::map<std::string, std::string> awsConfig_;
     config_reader::ApplicationConfig applicationConfig_;
+    utils::ThreadPolicy threadPolicy_; ///< Built from `threadPinning`/`captureReservedCores`, logged at startup
     const std::map<std::string, std::string> sysInfo_;
 };
 
@@ -1,11 +1,15 @@
 #pragma once
 
+#include "detection_lib_version.h"
+
 #include "sqlite_orm/sqlite_orm.h"
 
 #include <filesystem>
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <optional>
 
 namespace edf::db {
 struct Face {
@@ -25,6 +29,9 @@ struct Face {
     size_t grid_index    = 0;
     bool uploaded        = false;
     bool deleted_locally = false;
+    std::string source_file;          ///< Recording the face was found in; empty for live capture
+    long long media_position_ms = -1; ///< Presentation time of the frame in `source_file`, -1 for live capture
+    long long media_frame       = -1; ///< Frame index in `source_file`, -1 for live capture
 };
 
 struct Voice {
@@ -40,6 +47,24 @@ struct Voice {
     std::string artifact_location;
     bool uploaded        = false;
     bool deleted_locally = false;
+    std::string artifact_error; ///< Why `artifact_location` is empty when the audio could not be stored
+};
+
+/// Lifecycle of a file in a batch directory scan, stored as `ScanJob::status`.
+enum class ScanStatus : int { Pending = 0, Running = 1, Done = 2, Failed = 3, Skipped = 4 };
+
+struct ScanJob {
+    int id = -1;
+    std::string path;
+    long long file_size     = 0;
+    long long modified_time = 0; ///< Last write time of the file when it was queued, in file clock ticks
+    std::string content_hash;    ///< See scanContentHash in scan_queue.h
+    int status           = static_cast<int>(ScanStatus::Pending);
+    long long offset     = 0; ///< Checkpoint: work units (frames for video) already scanned
+    long long total      = 0; ///< Work units in the file, 0 if unknown
+    int attempts         = 0;
+    long long updated_at = 0;
+    std::string error; ///< Message of the last failed attempt
 };
 
 inline auto initStorage(const std::filesystem::path& path) {
@@ -61,7 +86,10 @@ inline auto initStorage(const std::filesystem::path& path) {
                                    make_column("raw_artifact_location", &Face::raw_artifact_location),
                                    make_column("grid_index", &Face::grid_index),
                                    make_column("uploaded", &Face::uploaded),
-                                   make_column("deleted_locally", &Face::deleted_locally, default_value(false))),
+                                   make_column("deleted_locally", &Face::deleted_locally, default_value(false)),
+                                   make_column("source_file", &Face::source_file, default_value("")),
+                                   make_column("media_position_ms", &Face::media_position_ms, default_value(-1)),
+                                   make_column("media_frame", &Face::media_frame, default_value(-1))),
 
                         make_table("voices",
                                    make_column("serial_number", &Voice::serial_number, primary_key()),
@@ -75,11 +103,30 @@ inline auto initStorage(const std::filesystem::path& path) {
                                    make_column("background_run", &Voice::background_run),
                                    make_column("artifact_location", &Voice::artifact_location),
                                    make_column("uploaded", &Voice::uploaded),
-                                   make_column("deleted_locally", &Voice::deleted_locally, default_value(false))));
+                                   make_column("deleted_locally", &Voice::deleted_locally, default_value(false)),
+                                   make_column("artifact_error", &Voice::artifact_error, default_value(""))),
+
+                        make_table("scan_jobs",
+                                   make_column("id", &ScanJob::id, primary_key()),
+                                   make_column("path", &ScanJob::path, unique()),
+                                   make_column("file_size", &ScanJob::file_size),
+                                   make_column("modified_time", &ScanJob::modified_time),
+                                   make_column("content_hash", &ScanJob::content_hash),
+                                   make_column("status", &ScanJob::status),
+                                   make_column("offset", &ScanJob::offset),
+                                   make_column("total", &ScanJob::total),
+                                   make_column("attempts", &ScanJob::attempts),
+                                   make_column("updated_at", &ScanJob::updated_at),
+                                   make_column("error", &ScanJob::error)));
 }
 
 using Storage = decltype(initStorage(""));
 
+/**
+ * Results database shared by the detection threads (face and voice rows), the voice artifact writer and the directory
+ * scan queue. Every member function holds `mutex` for the duration of its statements, so one instance can be used
+ * from all of them at once.
+ */
 class Database {
   public:
     const std::filesystem::path db_file_name = "db.sqlite";
@@ -96,9 +143,25 @@ class Database {
     void mark_as_uploaded(Voice);
     void mark_as_deleted(Face);
     void mark_as_deleted(Voice);
+    /**
+     * Removes the faces found in `source_file` at or after `first_frame` and returns them, so their artifacts can be
+     * deleted too. A resumed file scan calls this first, which makes re-analysing a frame replace its rows.
+     */
+    std::vector<Face> remove_file_faces_from(const std::string& source_file, long long first_frame);
+
+    /// Inserts a scan job and returns its id.
+    int insert(ScanJob);
+    void update(const ScanJob&);
+    std::optional<ScanJob> get_scan_job(const std::string& path) const;
+    std::vector<ScanJob> get_scan_jobs(ScanStatus status) const;
+    /// Whether a file with this content has already been scanned to completion, under any path.
+    bool has_scanned_content(const std::string& content_hash) const;
+    /// Records a checkpoint without rewriting the rest of the row.
+    void update_scan_offset(int id, long long offset, long long total);
 
   private:
     std::unique_ptr<Storage> storage;
     const std::filesystem::path db_path;
+    mutable std::mutex mutex; ///< Serialises every access to `storage`
 };
 } // namespace edf::db
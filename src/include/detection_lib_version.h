@@ -0,0 +1,26 @@
+/**
+ * @file detection_lib_version.h
+ * @brief Version of the `detection_program_lib` interface declared by the headers in src/include.
+ *
+ * `ApplicationController`, `db::Database`, `vision::InferenceEngine`, `voice::InferenceEngineVoice` and
+ * `voice::AudioCapture` are implemented in the prebuilt `detection_program_lib`. Their data members and out-of-line
+ * member functions must match the build of the library they are linked with, so the interface carries a version that
+ * is bumped whenever one of those declarations changes (BUILD_INSTRUCTIONS.md, "detection_program_lib interface
+ * version", lists what each version adds).
+ *
+ * Every translation unit including one of those headers refers to `edf_detection_program_lib_api_<version>`, which
+ * only a library built from headers of the same version defines. Linking against an older build therefore fails with
+ * an undefined reference to that symbol, instead of running with mismatched class layouts.
+ */
+
+#pragma once
+
+#define EDF_DETECTION_LIB_API_VERSION 2
+
+/// Defined by `detection_program_lib` builds of interface version 2; returns `EDF_DETECTION_LIB_API_VERSION`.
+extern "C" int edf_detection_program_lib_api_2();
+
+namespace edf::detail {
+// Odr-uses the version symbol from every translation unit that includes a library header
+inline const int detectionLibApiVersion = edf_detection_program_lib_api_2();
+} // namespace edf::detail
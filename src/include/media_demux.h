@@ -0,0 +1,358 @@
+/**
+ * @file media_demux.h
+ * @brief Concurrent decoding of the audio and video tracks of one media file on a shared timeline.
+ *
+ * Each track is decoded on its own thread into its own bounded queue, so the voice and video pipelines consume the
+ * file side by side instead of in two passes. Video frames carry the presentation time reported by the container.
+ * Audio chunks are timed by counting samples from the start of the audio track, shifted by the track's offset
+ * against the video, so both modalities can be placed on the same timeline (see segment_fusion.h).
+ *
+ * Audio is read through OpenCV's audio capture support: Media Foundation on Windows, GStreamer elsewhere. OpenCV's
+ * FFmpeg backend decodes video only, so on Linux an OpenCV built without GStreamer opens no audio track at all; the
+ * demuxer then reports why in `audioProblem()` and the file is analysed without its audio.
+ */
+
+#pragma once
+
+#include "vision/video_file_decoder.h"
+#include "voice/audio_buffer.h"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 6269 26495 6294 6201)
+#endif
+#include "opencv2/opencv.hpp"
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace edf {
+
+/**
+ * @brief Decoded audio of one file with its position on the media timeline.
+ */
+struct MediaAudioChunk {
+    std::chrono::microseconds pts{0}; ///< Presentation time of the first sample
+    voice::AudioBuffer buffer;        ///< Interleaved float32 at the track's own rate
+
+    std::chrono::microseconds duration() const {
+        return std::chrono::microseconds(
+            buffer.rate == 0 ? 0 : static_cast<long long>(buffer.num_samples()) * 1000000 / buffer.rate);
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief Bounded hand-off between a track decoder and its consumer.
+ */
+template <typename T> class TrackQueue {
+  public:
+    explicit TrackQueue(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+    /// Waits for room; false once the queue is stopped.
+    bool push(T&& item) {
+        std::unique_lock lock{mutex_};
+        spaceFree_.wait(lock, [this] { return stopped_ || items_.size() < capacity_; });
+        if (stopped_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        lock.unlock();
+        itemReady_.notify_one();
+        return true;
+    }
+
+    /// Waits for an item; false once the track is finished and drained, or stopped.
+    bool pop(T& item) {
+        std::unique_lock lock{mutex_};
+        itemReady_.wait(lock, [this] { return stopped_ || finished_ || !items_.empty(); });
+        if (stopped_ || items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        spaceFree_.notify_one();
+        return true;
+    }
+
+    /// Called by the decoder after its last item.
+    void finish() {
+        {
+            std::lock_guard lock{mutex_};
+            finished_ = true;
+        }
+        itemReady_.notify_all();
+    }
+
+    void stop() {
+        {
+            std::lock_guard lock{mutex_};
+            stopped_ = true;
+        }
+        itemReady_.notify_all();
+        spaceFree_.notify_all();
+    }
+
+  private:
+    const size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable itemReady_;
+    std::condition_variable spaceFree_;
+    std::deque<T> items_;
+    bool finished_ = false;
+    bool stopped_  = false;
+};
+
+} // namespace detail
+
+/**
+ * @brief How `MediaDemuxer` cuts and buffers the tracks.
+ */
+struct MediaDemuxOptions {
+    std::chrono::milliseconds audioChunk{250}; ///< Length of each audio chunk, like live capture chunks
+    int videoStride = 1;                       ///< Keep every n-th video frame
+    size_t capacity = 32;                      ///< Decoded frames/chunks buffered per track
+};
+
+/**
+ * @class MediaDemuxer
+ * @brief Decodes the audio and video tracks of a file concurrently for the voice and video pipelines.
+ */
+class MediaDemuxer {
+  public:
+    /**
+     * @throws std::runtime_error if the file has neither a readable video nor a readable audio track.
+     */
+    explicit MediaDemuxer(const std::filesystem::path& path, MediaDemuxOptions options = {})
+        : options_(options), videoQueue_(options.capacity), audioQueue_(options.capacity) {
+        options_.videoStride = std::max(options_.videoStride, 1);
+        video_.open(path.string());
+        openAudio(path);
+        hasVideo_ = video_.isOpened();
+        hasAudio_ = audio_.isOpened();
+        if (!hasVideo_) {
+            videoProblem_ = "No video track OpenCV can decode";
+        }
+        if (!hasVideo_ && !hasAudio_) {
+            throw std::runtime_error("Could not open media file " + path.string());
+        }
+
+        if (hasVideo_) {
+            videoDecoder_ = std::thread([this] { decodeVideo(); });
+        } else {
+            videoQueue_.finish();
+        }
+        if (hasAudio_) {
+            audioDecoder_ = std::thread([this] { decodeAudio(); });
+        } else {
+            audioQueue_.finish();
+        }
+    }
+
+    MediaDemuxer(const MediaDemuxer&)            = delete;
+    MediaDemuxer& operator=(const MediaDemuxer&) = delete;
+
+    ~MediaDemuxer() {
+        stop();
+        if (videoDecoder_.joinable()) {
+            videoDecoder_.join();
+        }
+        if (audioDecoder_.joinable()) {
+            audioDecoder_.join();
+        }
+    }
+
+    bool hasVideo() const { return hasVideo_; }
+
+    bool hasAudio() const { return hasAudio_; }
+
+    /// Why the video track is missing, or why it ended before the end of the file; empty when it decoded fully.
+    std::string videoProblem() const {
+        std::lock_guard lock{problemMutex_};
+        return videoProblem_;
+    }
+
+    /// Why the audio track is missing, or why it ended before the end of the file; empty when it decoded fully.
+    std::string audioProblem() const {
+        std::lock_guard lock{problemMutex_};
+        return audioProblem_;
+    }
+
+    unsigned long audioRate() const { return audioRate_; }
+
+    size_t audioChannels() const { return audioChannels_; }
+
+    /// Next video frame in presentation order; `positionMs` is the container timestamp. Call from one thread.
+    bool nextVideoFrame(vision::DecodedFrame& frame) { return videoQueue_.pop(frame); }
+
+    /// Next audio chunk in presentation order. Call from one thread, which may differ from the video consumer's.
+    bool nextAudioChunk(MediaAudioChunk& chunk) { return audioQueue_.pop(chunk); }
+
+    /// Makes both decoders and every pending `next*` call return.
+    void stop() {
+        videoQueue_.stop();
+        audioQueue_.stop();
+    }
+
+  private:
+    void openAudio(const std::filesystem::path& path) {
+        const std::vector<int> params{cv::CAP_PROP_AUDIO_STREAM,
+                                      0,
+                                      cv::CAP_PROP_VIDEO_STREAM,
+                                      -1,
+                                      cv::CAP_PROP_AUDIO_DATA_DEPTH,
+                                      CV_32F};
+#ifdef _WIN32
+        const int api = cv::CAP_MSMF;
+#else
+        const int api = cv::CAP_ANY;
+#endif
+        if (!audio_.open(path.string(), api, params)) {
+#ifdef _WIN32
+            audioProblem_ = "No audio track Media Foundation can decode";
+#else
+            audioProblem_ = "No audio track, or OpenCV has no audio capture backend (it needs GStreamer support)";
+#endif
+            return;
+        }
+        audioBaseIndex_ = static_cast<int>(audio_.get(cv::CAP_PROP_AUDIO_BASE_INDEX));
+        audioChannels_  = static_cast<size_t>(std::max(0.0, audio_.get(cv::CAP_PROP_AUDIO_TOTAL_CHANNELS)));
+        audioRate_      = static_cast<unsigned long>(std::max(0.0, audio_.get(cv::CAP_PROP_AUDIO_SAMPLES_PER_SECOND)));
+        // Audio that starts after (or before) the first video frame
+        audioShift_ = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::duration<double, std::nano>(audio_.get(cv::CAP_PROP_AUDIO_SHIFT_NSEC)));
+        if (audioChannels_ == 0 || audioRate_ == 0) {
+            audioProblem_ = "The audio track reports no channels or sample rate";
+            audio_.release();
+        }
+    }
+
+    void decodeVideo() {
+        try {
+            for (long long index = 0; video_.grab(); ++index) {
+                if (index % options_.videoStride != 0) {
+                    continue;
+                }
+                vision::DecodedFrame frame;
+                frame.index      = index;
+                frame.positionMs = video_.get(cv::CAP_PROP_POS_MSEC);
+                if (!video_.retrieve(frame.pixels) || frame.pixels.empty()) {
+                    continue;
+                }
+                if (!videoQueue_.push(std::move(frame))) {
+                    break;
+                }
+            }
+        } catch (const cv::Exception& e) {
+            // The frames decoded so far are still analysed; the track simply ends early
+            setProblem(videoProblem_, std::string("Video decoding failed: ") + e.what());
+        }
+        videoQueue_.finish();
+    }
+
+    void decodeAudio() {
+        const size_t chunkFrames = std::max<size_t>(options_.audioChunk.count() * audioRate_ / 1000, 1);
+        long long decodedFrames  = 0; // per channel, from the start of the track
+        MediaAudioChunk chunk;
+        std::vector<cv::Mat> channels(audioChannels_);
+
+        auto startChunk = [&] {
+            const auto offset             = std::chrono::microseconds(decodedFrames * 1000000 / audioRate_);
+            chunk.pts                     = audioShift_ + offset;
+            chunk.buffer.rate             = audioRate_;
+            chunk.buffer.channels         = audioChannels_;
+            chunk.buffer.bytes_per_sample = sizeof(float);
+            chunk.buffer.is_float         = true;
+            chunk.buffer.samples.clear();
+            chunk.buffer.samples.reserve(chunkFrames * audioChannels_ * sizeof(float));
+        };
+
+        try {
+            startChunk();
+            while (audio_.grab()) {
+                size_t frames = std::numeric_limits<size_t>::max();
+                bool retrieved = true;
+                for (size_t c = 0; c < audioChannels_ && retrieved; ++c) {
+                    retrieved = audio_.retrieve(channels[c], audioBaseIndex_ + static_cast<int>(c)) &&
+                                channels[c].type() == CV_32F;
+                    frames    = std::min(frames, channels[c].total());
+                }
+                // Skipping the block would shift every later chunk on the timeline, so the track ends here instead
+                if (!retrieved) {
+                    setProblem(audioProblem_, "Audio decoding stopped: a channel could not be retrieved as float32");
+                    break;
+                }
+                // Interleave the planar channels, cutting chunks of exactly chunkFrames
+                for (size_t f = 0; f < frames;) {
+                    const size_t have = chunk.buffer.num_samples();
+                    const size_t take = std::min(frames - f, chunkFrames - have);
+                    chunk.buffer.samples.resize((have + take) * audioChannels_ * sizeof(float));
+                    auto* out = reinterpret_cast<float*>(chunk.buffer.samples.data()) + have * audioChannels_;
+                    for (size_t c = 0; c < audioChannels_; ++c) {
+                        const float* in = channels[c].ptr<float>() + f;
+                        for (size_t i = 0; i < take; ++i) {
+                            out[i * audioChannels_ + c] = in[i];
+                        }
+                    }
+                    f += take;
+                    decodedFrames += static_cast<long long>(take);
+                    if (have + take == chunkFrames) {
+                        if (!audioQueue_.push(std::move(chunk))) {
+                            audioQueue_.finish();
+                            return;
+                        }
+                        chunk = {};
+                        startChunk();
+                    }
+                }
+            }
+            if (!chunk.buffer.samples.empty()) {
+                audioQueue_.push(std::move(chunk));
+            }
+        } catch (const cv::Exception& e) {
+            // As for video: the audio decoded so far is still analysed
+            setProblem(audioProblem_, std::string("Audio decoding failed: ") + e.what());
+        }
+        audioQueue_.finish();
+    }
+
+    void setProblem(std::string& problem, std::string text) {
+        std::lock_guard lock{problemMutex_};
+        problem = std::move(text);
+    }
+
+    MediaDemuxOptions options_;
+    cv::VideoCapture video_; // used only by videoDecoder_ once it runs
+    cv::VideoCapture audio_; // used only by audioDecoder_ once it runs
+    bool hasVideo_           = false;
+    bool hasAudio_           = false;
+    int audioBaseIndex_      = 0;
+    size_t audioChannels_    = 0;
+    unsigned long audioRate_ = 0;
+    std::chrono::microseconds audioShift_{0};
+    mutable std::mutex problemMutex_; // the decoder threads report problems while consumers may read them
+    std::string videoProblem_;
+    std::string audioProblem_;
+
+    detail::TrackQueue<vision::DecodedFrame> videoQueue_;
+    detail::TrackQueue<MediaAudioChunk> audioQueue_;
+    std::thread videoDecoder_;
+    std::thread audioDecoder_;
+};
+
+} // namespace edf
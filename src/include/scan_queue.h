@@ -0,0 +1,309 @@
+/**
+ * @file scan_queue.h
+ * @brief Persistent, resumable queue for scanning directory trees of recordings.
+ *
+ * Every matching file under a scan root gets a `db::ScanJob` row in the results database with its status, a
+ * checkpoint and a content hash. Workers claim pending jobs, checkpoint while they scan and mark each job done or
+ * failed, so a restarted scan continues where the last one stopped: finished files are skipped, interrupted files
+ * resume from their checkpoint, and a file whose size or modification time changed is scanned again from the start.
+ * Files whose content was already scanned under another path are skipped as duplicates.
+ */
+
+#pragma once
+
+#include "database.h"
+#include "utils/logger.h"
+#include "utils/worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace edf {
+
+/**
+ * @brief Fingerprint of a file's content: 64-bit FNV-1a over its size and its first and last MiB, as hex.
+ *
+ * Hashing whole multi-gigabyte recordings would cost as much I/O as scanning them, while re-encoded, trimmed or
+ * edited copies already differ in size or in these samples.
+ *
+ * @return An empty string if the file cannot be read.
+ */
+inline std::string scanContentHash(const std::filesystem::path& path) {
+    constexpr std::uint64_t prime = 1099511628211ULL;
+    constexpr size_t sampleBytes  = 1 << 20;
+    std::uint64_t hash            = 14695981039346656037ULL;
+
+    auto mix = [&](const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+        }
+    };
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    std::ifstream file(path, std::ios::binary);
+    if (ec || !file) {
+        return {};
+    }
+    mix(reinterpret_cast<const char*>(&size), sizeof(size));
+    std::vector<char> sample(sampleBytes);
+    file.read(sample.data(), static_cast<std::streamsize>(std::min<std::uintmax_t>(size, sampleBytes)));
+    mix(sample.data(), static_cast<size_t>(file.gcount()));
+    if (size > sampleBytes) {
+        const auto tail = std::min<std::uintmax_t>(size - sampleBytes, sampleBytes);
+        file.seekg(static_cast<std::streamoff>(size - tail));
+        file.read(sample.data(), static_cast<std::streamsize>(tail));
+        mix(sample.data(), static_cast<size_t>(file.gcount()));
+    }
+
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i, hash >>= 4) {
+        hex[i] = digits[hash & 0xf];
+    }
+    return hex;
+}
+
+/**
+ * @class DirectoryScanQueue
+ * @brief Registers the files of a directory tree as scan jobs and works through them on a worker pool.
+ */
+class DirectoryScanQueue {
+  public:
+    struct Stats {
+        size_t queued  = 0; ///< Jobs waiting to be scanned from the start
+        size_t resumed = 0; ///< Jobs waiting to continue from a checkpoint
+        size_t skipped = 0; ///< Files already scanned, duplicates, or out of attempts
+        size_t done    = 0;
+        size_t failed  = 0;
+    };
+
+    /// Records that `offset` of `total` work units (0 if unknown) of the current file are scanned.
+    using Checkpoint = std::function<void(long long offset, long long total)>;
+
+    /**
+     * @brief Scans one file, starting at `job.offset` and reporting progress through the checkpoint.
+     *
+     * Returns true once the file is complete, false if it stopped early (e.g. `run` was cleared), and throws on
+     * failure.
+     */
+    using ScanFile = std::function<bool(const db::ScanJob& job, const Checkpoint& checkpoint)>;
+
+    /**
+     * @param database Holds the `scan_jobs` table; must outlive the queue.
+     * @param extensions Lower-case extensions, with the dot, of the files to scan.
+     * @param maxAttempts Starts before a file is given up on; an attempt that crashes the process counts too.
+     * @param checkpointInterval Minimum time between checkpoint writes of one job.
+     */
+    DirectoryScanQueue(db::Database& database,
+                       std::vector<std::string> extensions,
+                       int maxAttempts                              = 3,
+                       std::chrono::milliseconds checkpointInterval = std::chrono::seconds(5))
+        : database_(database), extensions_(std::move(extensions)), maxAttempts_(std::max(maxAttempts, 1)),
+          checkpointInterval_(checkpointInterval) {}
+
+    /**
+     * @brief Creates or refreshes the jobs of every matching file under `root`.
+     *
+     * Jobs left running by a process that did not exit cleanly become pending again, keeping their checkpoint.
+     * Unreadable directories are skipped, and so are entries whose type cannot be read (e.g. dangling symlinks).
+     */
+    Stats enqueueDirectory(const std::filesystem::path& root) {
+        Stats stats;
+        std::error_code ec;
+        const auto options = std::filesystem::directory_options::skip_permission_denied;
+        for (std::filesystem::recursive_directory_iterator it(root, options, ec), end; !ec && it != end;
+             it.increment(ec)) {
+            // Checked with its own error code: `ec` drives the walk, and one bad entry must not end it
+            std::error_code entryError;
+            const bool regularFile = it->is_regular_file(entryError);
+            if (entryError) {
+                LOG_WARN("Skipping {} in scan directory: {}", it->path().string(), entryError.message());
+                continue;
+            }
+            if (regularFile && matches(it->path())) {
+                enqueueFile(it->path(), stats);
+            }
+        }
+        if (ec) {
+            LOG_ERROR("Could not list scan directory {}: {}", root.string(), ec.message());
+        }
+        return stats;
+    }
+
+    /**
+     * @brief Scans the pending jobs on `pool` and the calling thread until none are left or `run` is cleared.
+     *
+     * At most `pool.size() + 1` files are scanned at the same time.
+     */
+    Stats process(std::atomic_bool& run, utils::WorkerPool& pool, const ScanFile& scanFile) {
+        std::vector<db::ScanJob> jobs;
+        {
+            std::lock_guard lock{mutex_};
+            jobs = database_.get_scan_jobs(db::ScanStatus::Pending);
+        }
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::atomic<size_t> failed{0};
+        pool.parallelFor(std::min(jobs.size(), pool.size() + 1), [&](size_t) {
+            for (size_t i = next++; run && i < jobs.size(); i = next++) {
+                switch (scan(jobs[i], scanFile)) {
+                case db::ScanStatus::Done:
+                    ++done;
+                    break;
+                case db::ScanStatus::Failed:
+                    ++failed;
+                    break;
+                default:
+                    break;
+                }
+            }
+        });
+        Stats stats;
+        stats.done   = done;
+        stats.failed = failed;
+        return stats;
+    }
+
+  private:
+    bool matches(const std::filesystem::path& path) const {
+        auto extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        return std::find(extensions_.begin(), extensions_.end(), extension) != extensions_.end();
+    }
+
+    static long long now() {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void enqueueFile(const std::filesystem::path& file, Stats& stats) {
+        std::error_code ec;
+        const auto path = std::filesystem::absolute(file, ec).lexically_normal().string();
+        const auto size = static_cast<long long>(std::filesystem::file_size(file, ec));
+        if (ec) {
+            return;
+        }
+        const auto modifiedAt = std::filesystem::last_write_time(file, ec);
+        const auto modified   = static_cast<long long>(modifiedAt.time_since_epoch().count());
+        if (ec) {
+            return;
+        }
+
+        std::lock_guard lock{mutex_};
+        auto existing = database_.get_scan_job(path);
+        if (existing && existing->file_size == size && existing->modified_time == modified) {
+            auto& job         = *existing;
+            const auto status = static_cast<db::ScanStatus>(job.status);
+            if (status == db::ScanStatus::Done || status == db::ScanStatus::Skipped ||
+                (status == db::ScanStatus::Failed && job.attempts >= maxAttempts_)) {
+                ++stats.skipped;
+                return;
+            }
+            if (status == db::ScanStatus::Running && job.attempts >= maxAttempts_) {
+                // Every attempt so far ended with the process going down mid-scan
+                job.status = static_cast<int>(db::ScanStatus::Failed);
+                job.error  = "Scan interrupted " + std::to_string(job.attempts) + " times";
+                database_.update(job);
+                ++stats.skipped;
+                return;
+            }
+            if (status != db::ScanStatus::Pending) {
+                job.status     = static_cast<int>(db::ScanStatus::Pending);
+                job.updated_at = now();
+                database_.update(job);
+            }
+            ++(job.offset > 0 ? stats.resumed : stats.queued);
+            return;
+        }
+
+        // New or changed since it was queued: the checkpoint no longer applies
+        db::ScanJob job   = existing.value_or(db::ScanJob{});
+        job.path          = path;
+        job.file_size     = size;
+        job.modified_time = modified;
+        job.content_hash  = scanContentHash(file);
+        job.offset        = 0;
+        job.total         = 0;
+        job.attempts      = 0;
+        job.error.clear();
+        job.updated_at      = now();
+        const bool seenCopy = !job.content_hash.empty() && database_.has_scanned_content(job.content_hash);
+        job.status          = static_cast<int>(seenCopy ? db::ScanStatus::Skipped : db::ScanStatus::Pending);
+        if (existing) {
+            database_.update(job);
+        } else {
+            job.id = database_.insert(job);
+        }
+        ++(seenCopy ? stats.skipped : stats.queued);
+    }
+
+    db::ScanStatus scan(db::ScanJob& job, const ScanFile& scanFile) {
+        // Counted before the scan starts, so a file that brings the process down is not retried forever
+        ++job.attempts;
+        job.status     = static_cast<int>(db::ScanStatus::Running);
+        job.updated_at = now();
+        {
+            std::lock_guard lock{mutex_};
+            database_.update(job);
+        }
+
+        auto lastCheckpoint         = std::chrono::steady_clock::now();
+        const Checkpoint checkpoint = [&](long long offset, long long total) {
+            job.offset = offset;
+            job.total  = total;
+            if (std::chrono::steady_clock::now() - lastCheckpoint >= checkpointInterval_) {
+                lastCheckpoint = std::chrono::steady_clock::now();
+                std::lock_guard lock{mutex_};
+                database_.update_scan_offset(job.id, offset, total);
+            }
+        };
+
+        bool complete = false;
+        std::string error;
+        try {
+            complete = scanFile(job, checkpoint);
+        } catch (const std::exception& e) {
+            error = e.what();
+        } catch (...) {
+            error = "Unknown error";
+        }
+
+        db::ScanStatus status = db::ScanStatus::Done;
+        if (!error.empty()) {
+            LOG_ERROR("Scanning {} failed (attempt {}): {}", job.path, job.attempts, error);
+            status = job.attempts >= maxAttempts_ ? db::ScanStatus::Failed : db::ScanStatus::Pending;
+        } else if (!complete) {
+            // Stopped on request; not a failed attempt
+            --job.attempts;
+            status = db::ScanStatus::Pending;
+        }
+        job.status     = static_cast<int>(status);
+        job.error      = error;
+        job.updated_at = now();
+        std::lock_guard lock{mutex_};
+        database_.update(job);
+        return status;
+    }
+
+    db::Database& database_;
+    const std::vector<std::string> extensions_;
+    const int maxAttempts_;
+    const std::chrono::milliseconds checkpointInterval_;
+    std::mutex mutex_; // keeps read-then-write of a job atomic across workers; Database serialises single calls
+};
+
+} // namespace edf
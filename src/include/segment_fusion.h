@@ -0,0 +1,163 @@
+/**
+ * @file segment_fusion.h
+ * @brief Per-time-segment fusion of voice and video results of one media file.
+ *
+ * The voice and video pipelines run concurrently and at different rates, so their results arrive interleaved and
+ * out of step. Each result is placed by its presentation time into a fixed-length segment of the media timeline. A
+ * segment is complete once both pipelines have reported past its end (or finished), and complete segments are
+ * handed out in timeline order with the evidence of both modalities side by side.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace edf {
+
+/**
+ * @brief Voice and video evidence for one segment of the media timeline.
+ */
+struct FusedSegment {
+    std::chrono::milliseconds start{0};
+    std::chrono::milliseconds end{0};
+
+    std::optional<float> voiceScore; ///< Highest voice score of the windows ending in the segment
+    size_t voiceWindows     = 0;
+    size_t fakeVoiceWindows = 0;
+
+    std::optional<float> faceScore; ///< Highest face score of the frames in the segment
+    size_t videoFrames = 0;
+    size_t faces       = 0;
+    size_t fakeFaces   = 0;
+
+    bool voiceFake() const { return fakeVoiceWindows > 0; }
+
+    bool videoFake() const { return fakeFaces > 0; }
+};
+
+/**
+ * @class SegmentFusion
+ * @brief Collects results from both pipelines (from any thread) and releases complete segments in order.
+ */
+class SegmentFusion {
+  public:
+    /**
+     * @param segment Length of one segment.
+     * @param hasVoice / hasVideo Whether the file has the track; a missing one never holds segments back.
+     */
+    SegmentFusion(std::chrono::milliseconds segment, bool hasVoice, bool hasVideo)
+        : segmentUs_(std::max<long long>(std::chrono::microseconds(segment).count(), 1)) {
+        if (!hasVoice) {
+            voiceWatermark_ = done;
+        }
+        if (!hasVideo) {
+            videoWatermark_ = done;
+        }
+    }
+
+    /**
+     * @brief Records the score of the voice window ending at `pts`.
+     */
+    void addVoiceScore(std::chrono::microseconds pts, float score, bool fake) {
+        std::lock_guard lock{mutex_};
+        auto& segment      = at(pts - std::chrono::microseconds(1)); // the window ends at pts, exclusive
+        segment.voiceScore = std::max(segment.voiceScore.value_or(score), score);
+        ++segment.voiceWindows;
+        segment.fakeVoiceWindows += fake ? 1 : 0;
+        voiceWatermark_ = std::max<long long>(voiceWatermark_, pts.count());
+    }
+
+    /**
+     * @brief Records the faces found in the frame shown at `pts`.
+     *
+     * @param maxScore Highest face score in the frame, unset if it had no faces.
+     */
+    void addVideoFrame(std::chrono::microseconds pts, size_t faces, size_t fakeFaces, std::optional<float> maxScore) {
+        std::lock_guard lock{mutex_};
+        auto& segment = at(pts);
+        ++segment.videoFrames;
+        segment.faces += faces;
+        segment.fakeFaces += fakeFaces;
+        if (maxScore) {
+            segment.faceScore = std::max(segment.faceScore.value_or(*maxScore), *maxScore);
+        }
+        videoWatermark_ = std::max<long long>(videoWatermark_, pts.count());
+    }
+
+    /// The voice pipeline has processed everything up to `pts` (e.g. a chunk without a new score).
+    void advanceVoice(std::chrono::microseconds pts) {
+        std::lock_guard lock{mutex_};
+        voiceWatermark_ = std::max<long long>(voiceWatermark_, pts.count());
+    }
+
+    void advanceVideo(std::chrono::microseconds pts) {
+        std::lock_guard lock{mutex_};
+        videoWatermark_ = std::max<long long>(videoWatermark_, pts.count());
+    }
+
+    /// The voice track has ended; it no longer holds segments back.
+    void finishVoice() { advanceVoice(std::chrono::microseconds(done)); }
+
+    void finishVideo() { advanceVideo(std::chrono::microseconds(done)); }
+
+    /**
+     * @brief Removes and returns the segments both pipelines have moved past, in timeline order.
+     *
+     * Segments without any result are included while they lie before the last result seen, so the timeline has no
+     * gaps.
+     */
+    std::vector<FusedSegment> takeCompleted() {
+        std::lock_guard lock{mutex_};
+        std::vector<FusedSegment> completed;
+        const long long watermark = std::min(voiceWatermark_, videoWatermark_);
+        while (next_ <= last_ && (next_ + 1) * segmentUs_ <= watermark) {
+            auto it = segments_.find(next_);
+            if (it == segments_.end()) {
+                completed.push_back(empty(next_));
+            } else {
+                completed.push_back(it->second);
+                segments_.erase(it);
+            }
+            ++next_;
+        }
+        return completed;
+    }
+
+  private:
+    static constexpr long long done = std::numeric_limits<long long>::max() / 2;
+
+    FusedSegment empty(long long index) const {
+        using std::chrono::duration_cast;
+        FusedSegment segment;
+        segment.start = duration_cast<std::chrono::milliseconds>(std::chrono::microseconds(index * segmentUs_));
+        segment.end   = duration_cast<std::chrono::milliseconds>(std::chrono::microseconds((index + 1) * segmentUs_));
+        return segment;
+    }
+
+    FusedSegment& at(std::chrono::microseconds pts) {
+        // Results timed before a segment that was already released are folded into the oldest pending one
+        const long long index = std::max<long long>(std::max<long long>(pts.count(), 0) / segmentUs_, next_);
+        last_                 = std::max(last_, index);
+        auto it               = segments_.find(index);
+        if (it == segments_.end()) {
+            it = segments_.emplace(index, empty(index)).first;
+        }
+        return it->second;
+    }
+
+    const long long segmentUs_;
+    std::mutex mutex_;
+    std::map<long long, FusedSegment> segments_;
+    long long next_           = 0;  ///< Index of the next segment to release
+    long long last_           = -1; ///< Highest segment index holding a result
+    long long voiceWatermark_ = 0;  ///< Microseconds up to which the voice pipeline has reported
+    long long videoWatermark_ = 0;
+};
+
+} // namespace edf
@@ -26,14 +26,49 @@ class ApplicationConfig {
     // app
     const char* modelDirectory;
     bool optOutOfScreenCapture;
+    bool threadPinning;       // pin capture and inference threads, see utils/thread_policy.h
+    int captureReservedCores; // physical cores kept for capture and I/O
+
+    // voice
+    int voiceModelSampleRate; // captured audio is normalised to mono float at this rate
+    bool voiceActivityGating; // opt-in: skip inference on windows without speech, see voice/voice_activity.h
+    float voiceActivityMinSpeechFraction;
+
+    bool voicePerChannelAnalysis; // score each capture channel separately, see voice/multi_stream.h
+    int voiceAnalysisWorkers;     // threads preparing the channels of a chunk
+
+    const char* voiceCaptureOverflowPolicy; // "block" (keeps all audio), "drop_oldest" or "coalesce", opt-in
+    int voiceCaptureMaxQueueDepth;          // queued capture chunks before the policy applies
+    int voiceCaptureCoalesceMs;             // newest audio kept when coalescing
+
+    int voiceCaptureChunkMs;   // capture chunk length; 0 captures whole captureDurationSecs windows
+    int voiceHopMs;            // streaming mode: score the sliding window this often, see voice/hop_scheduler.h
+    int voiceMaxBatchWindows;  // queued windows scored per TF_SessionRun when catching up
+    int voiceIntraOpThreads;   // TF session threads, 0 for the TensorFlow default, see voice/tf_session_config.h
+    int voiceInterOpThreads;
+    int voiceWarmupInferences; // inferences on silence while the model loads
+
+    const char* voiceArtifactFormat;     // "flac" or "opus", see voice/artifact_writer.h
+    float voiceArtifactCompressionLevel; // 0 fastest to 1 smallest
+
+    // Front-end/classifier split of the voice graph for cached features, see voice/feature_cache.h; empty disables
+    const char* voiceFrontEndInput;
+    const char* voiceFrontEndOutput;
+    const char* voiceClassifierInput;
+    const char* voiceClassifierOutput;
+    int voiceFrontEndFrameLength; // samples per feature frame at voiceModelSampleRate; 0 disables
+    int voiceFrontEndFrameShift;  // samples between feature frame starts
+    int voiceFrontEndFeatureDim;  // values per feature frame, e.g. mel bins
 
     // voice.generic
     const char* voiceGenericModelIdentifier;
+    const char* voiceGenericBackend; // "tensorflow" or "onnxruntime", see voice/onnx_voice_session.h
     float voiceGenericProbScoreThreshold;
     float voiceGenericFakeProportionThreshold;
 
     // voice.live
     const char* voiceLiveModelIdentifier;
+    const char* voiceLiveBackend;
     float voiceLiveProbScoreThreshold;
     float voiceLiveFakeProportionThreshold;
 
@@ -43,6 +78,21 @@ class ApplicationConfig {
     int videoRollingWindowExpiryDuration;
     int videoRollingWindowCooldownDuration;
     int videoRollingWindowMinimumAlertSize;
+    const char* videoInferencePrecision; // "fp32", "fp16", "bf16" or "auto", see vision/precision.h
+    const char* videoExecutionProviders; // comma separated, e.g. "openvino,dnnl,cpu", see vision/execution_providers.h
+    bool videoBenchmarkExecutionProviders;
+
+    int videoFileDecodeThreads; // file scans: decoder threads, 0 for half the logical processors
+    int videoFileFrameStride;   // file scans: analyse every n-th frame
+
+    int videoScanConcurrentFiles;        // directory scans: files decoded at the same time, see scan_queue.h
+    int videoScanMaxAttempts;            // directory scans: tries before a file is marked failed
+    int videoScanCheckpointSecs;         // directory scans: how often progress is saved
+    const char* videoScanFileExtensions; // directory scans: comma separated, e.g. ".mp4,.mkv"
+
+    // media
+    int mediaSegmentMs;    // synchronised audio+video scans: length of a fused timeline segment, see segment_fusion.h
+    int mediaAudioChunkMs; // audio chunk length fed to the voice engine, see media_demux.h
 
     // video.generic
     const char* videoGenericModelIdentifier;
@@ -14,12 +14,18 @@
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
 #endif
 
-#define SPDLOG_WCHAR_TO_UTF8_SUPPORT
+#ifdef _WIN32
+#define SPDLOG_WCHAR_TO_UTF8_SUPPORT // wide-string log arguments; spdlog supports it on Windows only
+#endif
 
+#ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 26498)
+#endif
 #include "spdlog/spdlog.h"
+#ifdef _MSC_VER
 #pragma warning(pop)
+#endif
 
 #include <memory>
 #include <filesystem>
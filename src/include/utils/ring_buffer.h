@@ -0,0 +1,166 @@
+/**
+ * @file ring_buffer.h
+ * @brief Fixed-capacity contiguous ring buffer holding a sliding window of trivially copyable values.
+ *
+ * Drop-in for `BoundedDeque` on hot paths: storage is a single power-of-two block allocated once, appends are one or
+ * two `memcpy` calls, dropping from the front only moves the head, and the window can be read back as at most two
+ * contiguous spans without copying.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace edf::utils {
+template <typename T> class RingBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "RingBuffer copies elements with memcpy");
+
+  public:
+    /// Two contiguous pieces which, concatenated, hold the window from oldest to newest.
+    using Spans = std::pair<std::span<const T>, std::span<const T>>;
+
+    explicit RingBuffer(size_t size)
+        : maxSize_(size), storage_(std::bit_ceil(std::max<size_t>(size, 1))), mask_(storage_.size() - 1) {}
+
+    explicit RingBuffer(T value, size_t size) : RingBuffer(size) { fill(value); }
+
+    void append(T element) {
+        if (maxSize_ == 0) {
+            return;
+        }
+        if (size_ == maxSize_) {
+            drop_front(1);
+        }
+        storage_[(head_ + size_) & mask_] = element;
+        ++size_;
+    }
+
+    void append(const T* elements, size_t count) {
+        if (count == 0 || maxSize_ == 0) {
+            return;
+        }
+        if (count >= maxSize_) {
+            elements += count - maxSize_;
+            count = maxSize_;
+            clear();
+        } else if (size_ + count > maxSize_) {
+            drop_front(size_ + count - maxSize_);
+        }
+        const size_t tail  = (head_ + size_) & mask_;
+        const size_t first = std::min(count, capacity() - tail);
+        std::memcpy(storage_.data() + tail, elements, first * sizeof(T));
+        std::memcpy(storage_.data(), elements + first, (count - first) * sizeof(T));
+        size_ += count;
+    }
+
+    void append(std::span<const T> elements) { append(elements.data(), elements.size()); }
+
+    void append(const std::vector<T>& elements) { append(elements.data(), elements.size()); }
+
+    void drop_front(size_t discardSize) {
+        discardSize = std::min(discardSize, size_);
+        head_       = (head_ + discardSize) & mask_;
+        size_ -= discardSize;
+    }
+
+    /// Removes up to `discardSize` of the newest elements.
+    void drop_back(size_t discardSize) { size_ -= std::min(discardSize, size_); }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+
+    size_t maxSize() const { return maxSize_; }
+
+    /// Allocated slots, the smallest power of two >= `maxSize()`.
+    size_t capacity() const { return storage_.size(); }
+
+    bool empty() const { return size_ == 0; }
+
+    bool full() const { return size_ == maxSize_; }
+
+    /// Element `index` of the window, 0 being the oldest.
+    const T& operator[](size_t index) const { return storage_[(head_ + index) & mask_]; }
+
+    const T& front() const { return (*this)[0]; }
+
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    Spans spans() const {
+        const size_t first = std::min(size_, capacity() - head_);
+        return {std::span<const T>{storage_.data() + head_, first}, std::span<const T>{storage_.data(), size_ - first}};
+    }
+
+    /**
+     * @brief Copies the `length` elements ending `endOffset` elements before the newest into `out`, oldest first,
+     *        filling the front with `T{}` where the window reaches past the oldest element held.
+     */
+    void copyWindow(T* out, size_t length, size_t endOffset = 0) const {
+        const size_t end  = size_ - std::min(endOffset, size_);
+        const size_t have = std::min(end, length);
+        std::fill(out, out + (length - have), T{});
+        const auto [first, second] = spans();
+        size_t skip   = end - have; // older elements before the window
+        size_t remain = have;
+        T* cursor     = out + (length - have);
+        for (auto part : {first, second}) {
+            const size_t drop = std::min(skip, part.size());
+            skip -= drop;
+            const size_t take = std::min(remain, part.size() - drop);
+            std::memcpy(cursor, part.data() + drop, take * sizeof(T));
+            cursor += take;
+            remain -= take;
+        }
+    }
+
+    /// Copies the window, oldest first, into `out` which must hold `size()` elements.
+    void copyTo(T* out) const {
+        if (size_ == 0) {
+            return;
+        }
+        const auto [first, second] = spans();
+        std::memcpy(out, first.data(), first.size_bytes());
+        std::memcpy(out + first.size(), second.data(), second.size_bytes());
+    }
+
+    std::vector<T> toVector() const {
+        std::vector<T> out(size_);
+        copyTo(out.data());
+        return out;
+    }
+
+    /// Changes the capacity to `size` elements and empties the window; the storage is reallocated when its slot count
+    /// changes.
+    void reset(size_t size) {
+        const size_t slots = std::bit_ceil(std::max<size_t>(size, 1));
+        if (slots != storage_.size()) {
+            storage_.assign(slots, T{});
+        }
+        maxSize_ = size;
+        mask_    = slots - 1;
+        clear();
+    }
+
+    void fill(T value) {
+        std::fill(storage_.begin(), storage_.end(), value);
+        head_ = 0;
+        size_ = maxSize_;
+    }
+
+  private:
+    size_t maxSize_;
+    std::vector<T> storage_;
+    size_t mask_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+} // namespace edf::utils
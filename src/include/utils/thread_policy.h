@@ -0,0 +1,323 @@
+/**
+ * @file thread_policy.h
+ * @brief CPU topology discovery and a shared threading policy for capture, inference and I/O.
+ *
+ * Screen/audio capture, OpenCV DNN, ONNX Runtime and TensorFlow each size their own thread pools to all logical
+ * processors. On small hyperthreaded laptops they oversubscribe the machine and SMT siblings end up contending for
+ * the same core. `ThreadPolicy` discovers physical cores and their SMT siblings once, keeps one physical core for
+ * capture and I/O, and sizes the inference pools to one thread per remaining physical core. Pinning threads to the
+ * resulting layout is optional (`threadPinning` in `[app]`).
+ */
+
+#pragma once
+
+#include "utils/logger.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace edf::utils {
+
+/**
+ * @brief One physical core and the logical processors (SMT siblings) it exposes.
+ */
+struct PhysicalCore {
+    int package = 0; ///< Physical package (socket)
+    int group   = 0; ///< Windows processor group `logicalProcessors` are numbered in; always 0 on Linux
+    std::vector<int> logicalProcessors;
+};
+
+namespace detail {
+
+/// Parses a Linux cpulist such as `0-3,8,10-11`.
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream stream{list};
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || range == "\n") {
+            continue;
+        }
+        const auto dash = range.find('-');
+        try {
+            const int first = std::stoi(range.substr(0, dash));
+            const int last  = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            // ignore malformed entries
+        }
+    }
+    return cpus;
+}
+
+#ifdef _WIN32
+/// Calls `visit` with every entry GetLogicalProcessorInformationEx returns for `relation`.
+template <typename Visit> void forEachProcessorRelation(LOGICAL_PROCESSOR_RELATIONSHIP relation, Visit&& visit) {
+    DWORD length = 0;
+    GetLogicalProcessorInformationEx(relation, nullptr, &length);
+    std::vector<char> buffer(length);
+    auto* info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+    if (length == 0 || !GetLogicalProcessorInformationEx(relation, info, &length)) {
+        return;
+    }
+    for (DWORD offset = 0; offset < length;) {
+        auto* entry = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+        visit(*entry);
+        offset += entry->Size;
+    }
+}
+#endif
+
+} // namespace detail
+
+/**
+ * @brief Lists the physical cores of the machine, ordered by package, processor group and first logical processor.
+ *
+ * Falls back to one core per logical processor when the topology cannot be read.
+ */
+inline std::vector<PhysicalCore> discoverPhysicalCores() {
+    std::vector<PhysicalCore> cores;
+#ifdef _WIN32
+    // Thread affinity masks only address the process's processor group, which covers every machine with <= 64
+    // logical processors; cores in other groups are left out
+    using Entry = SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX;
+    detail::forEachProcessorRelation(RelationProcessorCore, [&](const Entry& entry) {
+        PhysicalCore core;
+        core.group = entry.Processor.GroupMask[0].Group;
+        for (int bit = 0; bit < 64; ++bit) {
+            if (entry.Processor.GroupMask[0].Mask & (KAFFINITY{1} << bit)) {
+                core.logicalProcessors.push_back(bit);
+            }
+        }
+        if (core.group == 0 && !core.logicalProcessors.empty()) {
+            cores.push_back(std::move(core));
+        }
+    });
+    int package = 0;
+    detail::forEachProcessorRelation(RelationProcessorPackage, [&](const Entry& entry) {
+        for (WORD g = 0; g < entry.Processor.GroupCount; ++g) {
+            const auto& mask = entry.Processor.GroupMask[g];
+            for (auto& core : cores) {
+                if (core.group == mask.Group && (mask.Mask & (KAFFINITY{1} << core.logicalProcessors.front()))) {
+                    core.package = package;
+                }
+            }
+        }
+        ++package;
+    });
+#else
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    const bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    std::map<std::pair<int, std::string>, PhysicalCore> byCore;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (haveMask && !CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        const std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+        std::ifstream siblingsFile{topology + "thread_siblings_list"};
+        std::string siblings;
+        if (!std::getline(siblingsFile, siblings)) {
+            continue;
+        }
+        int package = 0;
+        std::ifstream{topology + "physical_package_id"} >> package;
+        auto& core   = byCore[{package, siblings}];
+        core.package = package;
+        core.logicalProcessors.push_back(cpu);
+    }
+    for (auto& [_, core] : byCore) {
+        cores.push_back(std::move(core));
+    }
+#endif
+    if (cores.empty()) {
+        const int logical = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < logical; ++cpu) {
+            cores.push_back({0, 0, {cpu}});
+        }
+    }
+    std::sort(cores.begin(), cores.end(), [](const PhysicalCore& a, const PhysicalCore& b) {
+        return std::tuple{a.package, a.group, a.logicalProcessors.front()} <
+               std::tuple{b.package, b.group, b.logicalProcessors.front()};
+    });
+    return cores;
+}
+
+/**
+ * @brief Pins the calling thread to the given logical processors.
+ *
+ * @return true on success; an empty list or a failing OS call leaves the affinity unchanged.
+ */
+inline bool pinCurrentThread(const std::vector<int>& logicalProcessors) {
+    if (logicalProcessors.empty()) {
+        return false;
+    }
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for (int cpu : logicalProcessors) {
+        if (cpu < 64) {
+            mask |= DWORD_PTR{1} << cpu;
+        }
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : logicalProcessors) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+/**
+ * @brief Logical processors the calling thread is currently allowed to run on.
+ */
+inline std::vector<int> currentThreadAffinity() {
+    std::vector<int> cpus;
+#ifdef _WIN32
+    const auto thread = GetCurrentThread();
+    const auto old    = SetThreadAffinityMask(thread, ~DWORD_PTR{0});
+    if (old != 0) {
+        SetThreadAffinityMask(thread, old);
+        for (int bit = 0; bit < 64; ++bit) {
+            if (old & (DWORD_PTR{1} << bit)) {
+                cpus.push_back(bit);
+            }
+        }
+    }
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+/**
+ * @class ThreadPolicy
+ * @brief Splits the machine between capture/I/O and inference.
+ *
+ * The first `reservedCores` physical cores (all of their SMT siblings) are kept for capture and I/O. Inference gets
+ * one thread per remaining physical core, placed on the first SMT sibling of each, so no two inference threads
+ * share a core. Machines with a single physical core share it between both roles.
+ */
+class ThreadPolicy {
+  public:
+    /**
+     * @param cores Topology, normally `discoverPhysicalCores()`.
+     * @param reservedCores Physical cores kept for capture and I/O.
+     * @param pinning Whether `pinCaptureThread`/`pinInferenceThread` actually set affinities.
+     */
+    explicit ThreadPolicy(std::vector<PhysicalCore> cores, int reservedCores = 1, bool pinning = false)
+        : cores_(std::move(cores)), pinning_(pinning) {
+        const int total    = static_cast<int>(cores_.size());
+        const int reserved = std::clamp(reservedCores, 0, std::max(total - 1, 0));
+        for (int i = 0; i < total; ++i) {
+            auto& logical = cores_[i].logicalProcessors;
+            if (i < reserved) {
+                captureProcessors_.insert(captureProcessors_.end(), logical.begin(), logical.end());
+            } else {
+                inferenceProcessors_.push_back(logical.front());
+            }
+        }
+        if (captureProcessors_.empty() && !cores_.empty()) {
+            captureProcessors_ = cores_.front().logicalProcessors;
+        }
+    }
+
+    /// Policy for the machine the process runs on.
+    static ThreadPolicy detect(int reservedCores = 1, bool pinning = false) {
+        return ThreadPolicy{discoverPhysicalCores(), reservedCores, pinning};
+    }
+
+    /// Threads each inference pool (OpenCV DNN, ONNX Runtime intra-op, TensorFlow intra-op) should use.
+    int inferenceThreads() const { return std::max(1, static_cast<int>(inferenceProcessors_.size())); }
+
+    /// Logical processors, one per physical core, reserved for inference.
+    const std::vector<int>& inferenceProcessors() const { return inferenceProcessors_; }
+
+    /// Logical processors reserved for capture and I/O.
+    const std::vector<int>& captureProcessors() const { return captureProcessors_; }
+
+    const std::vector<PhysicalCore>& cores() const { return cores_; }
+
+    bool pinning() const { return pinning_; }
+
+    /// Pins the calling capture/I/O thread to the reserved core when pinning is enabled.
+    bool pinCaptureThread() const { return pinning_ && pinCurrentThread(captureProcessors_); }
+
+    /**
+     * @brief Pins the calling inference thread to its own physical core when pinning is enabled.
+     *
+     * @param index Index of the thread within its pool; wraps around the inference cores.
+     */
+    bool pinInferenceThread(size_t index) const {
+        if (!pinning_ || inferenceProcessors_.empty()) {
+            return false;
+        }
+        return pinCurrentThread({inferenceProcessors_[index % inferenceProcessors_.size()]});
+    }
+
+    /// Human readable layout, e.g. `4 physical cores (8 logical); capture/IO on [0,4]; inference x3 on [1,2,3]`.
+    std::string describe() const {
+        auto join = [](const std::vector<int>& cpus) {
+            std::string out = "[";
+            for (size_t i = 0; i < cpus.size(); ++i) {
+                out += (i ? "," : "") + std::to_string(cpus[i]);
+            }
+            return out + "]";
+        };
+        size_t logical = 0;
+        for (const auto& core : cores_) {
+            logical += core.logicalProcessors.size();
+        }
+        return std::to_string(cores_.size()) + " physical cores (" + std::to_string(logical) +
+               " logical); capture/IO on " + join(captureProcessors_) + "; inference x" +
+               std::to_string(inferenceThreads()) + " on " + join(inferenceProcessors_) +
+               (pinning_ ? "; pinned" : "; not pinned");
+    }
+
+    /// Writes the layout to the application log.
+    void log() const { LOG_INFO("Thread layout: {}", describe()); }
+
+  private:
+    std::vector<PhysicalCore> cores_;
+    std::vector<int> captureProcessors_;
+    std::vector<int> inferenceProcessors_;
+    bool pinning_;
+};
+
+} // namespace edf::utils
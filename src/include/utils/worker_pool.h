@@ -0,0 +1,125 @@
+/**
+ * @file worker_pool.h
+ * @brief Fixed set of worker threads running index-parallel loops.
+ *
+ * Workers are started once and sleep between loops, so per-cycle work (one call per voice stream, per frame...) does
+ * not pay for thread creation. The calling thread takes part in every loop.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace edf::utils {
+class WorkerPool {
+  public:
+    /// `threads` helpers besides the caller; 0 runs every loop on the calling thread.
+    explicit WorkerPool(size_t threads) {
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    WorkerPool(const WorkerPool&)            = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief Calls `fn(i)` for every `i` in `[0, count)` across the pool and returns when all calls are done.
+     *
+     * The first exception thrown by `fn` is rethrown here once the loop has finished.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+        if (count == 0) {
+            return;
+        }
+        if (workers_.empty() || count == 1) {
+            for (size_t i = 0; i < count; ++i) {
+                fn(i);
+            }
+            return;
+        }
+        std::unique_lock lock{mutex_};
+        task_    = &fn;
+        count_   = count;
+        next_    = 0;
+        pending_ = count;
+        error_   = nullptr;
+        ++generation_;
+        wakeup_.notify_all();
+        runTasks(lock);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        task_ = nullptr;
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+  private:
+    void work() {
+        std::unique_lock lock{mutex_};
+        std::uint64_t seen = 0;
+        while (true) {
+            wakeup_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+            runTasks(lock);
+        }
+    }
+
+    // Claims indices of the current loop until none are left; called with the lock held
+    void runTasks(std::unique_lock<std::mutex>& lock) {
+        while (task_ != nullptr && next_ < count_) {
+            const size_t index = next_++;
+            const auto* task   = task_;
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                (*task)(index);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+            if (error && !error_) {
+                error_ = error;
+            }
+            if (--pending_ == 0) {
+                done_.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* task_ = nullptr;
+    size_t count_                            = 0;
+    size_t next_                             = 0;
+    size_t pending_                          = 0;
+    std::uint64_t generation_                = 0;
+    std::exception_ptr error_;
+    bool stopping_ = false;
+};
+} // namespace edf::utils
@@ -0,0 +1,272 @@
+/**
+ * @file detection_input.h
+ * @brief Fused colour conversion and area downscale of captured screens into the face detector input.
+ *
+ * Screen captures arrive at native resolution as 8-bit BGRA. Converting them to BGR and then resizing them to
+ * `videoCaffeDetectionSize` in two full-frame passes allocates two large temporaries per screen per cycle. The
+ * kernel below reads every source pixel exactly once, drops the alpha channel on the fly and writes the box-filtered
+ * result straight into a buffer that is reused across cycles. Both passes use SSE2 where available: source rows are
+ * widened and summed 16 bytes at a time, and each output pixel sums its box of accumulated pixels one pixel per
+ * register. Full resolution pixels are only converted for the regions that end up being cropped as faces.
+ */
+
+#pragma once
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 6269 26495 6294 6201)
+#endif
+#include "opencv2/opencv.hpp"
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#ifndef EDF_VISION_SSE2
+#define EDF_VISION_SSE2 1
+#endif
+#endif
+
+namespace edf::vision {
+
+namespace detail {
+
+/**
+ * @brief Adds one row of 8-bit samples into a row of 32-bit accumulators (`acc[i] += src[i]`).
+ */
+inline void accumulateRow(const std::uint8_t* src, std::uint32_t* acc, size_t count) {
+    size_t i = 0;
+#ifdef EDF_VISION_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        const __m128i px   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i lo16 = _mm_unpacklo_epi8(px, zero);
+        const __m128i hi16 = _mm_unpackhi_epi8(px, zero);
+        auto* out          = reinterpret_cast<__m128i*>(acc + i);
+        _mm_storeu_si128(out + 0, _mm_add_epi32(_mm_loadu_si128(out + 0), _mm_unpacklo_epi16(lo16, zero)));
+        _mm_storeu_si128(out + 1, _mm_add_epi32(_mm_loadu_si128(out + 1), _mm_unpackhi_epi16(lo16, zero)));
+        _mm_storeu_si128(out + 2, _mm_add_epi32(_mm_loadu_si128(out + 2), _mm_unpacklo_epi16(hi16, zero)));
+        _mm_storeu_si128(out + 3, _mm_add_epi32(_mm_loadu_si128(out + 3), _mm_unpackhi_epi16(hi16, zero)));
+    }
+#endif
+    for (; i < count; ++i) {
+        acc[i] += src[i];
+    }
+}
+
+/**
+ * @brief Sums the first three channels of `count` accumulated pixels spaced `channels` apart.
+ *
+ * With SSE2 each pixel is one unaligned four-lane load, so with three channels the load reads the first channel of
+ * the next pixel; the accumulator row must hold one element past the last pixel.
+ */
+inline void sumBox(const std::uint32_t* acc, size_t count, int channels, std::uint32_t (&sums)[3]) {
+#ifdef EDF_VISION_SSE2
+    __m128i total = _mm_setzero_si128();
+    for (size_t i = 0; i < count; ++i, acc += channels) {
+        total = _mm_add_epi32(total, _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc)));
+    }
+    alignas(16) std::uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), total);
+    sums[0] = lanes[0];
+    sums[1] = lanes[1];
+    sums[2] = lanes[2];
+#else
+    sums[0] = sums[1] = sums[2] = 0;
+    for (size_t i = 0; i < count; ++i, acc += channels) {
+        sums[0] += acc[0];
+        sums[1] += acc[1];
+        sums[2] += acc[2];
+    }
+#endif
+}
+
+/**
+ * @brief Splits `srcLength` source pixels into `dstLength` boxes; box `i` covers `[offsets[i], offsets[i + 1])`.
+ *
+ * Requires `srcLength >= dstLength` so that every box covers at least one source pixel.
+ */
+inline void boxOffsets(int srcLength, int dstLength, std::vector<int>& offsets) {
+    offsets.resize(static_cast<size_t>(dstLength) + 1);
+    for (int i = 0; i <= dstLength; ++i) {
+        offsets[i] = static_cast<int>(static_cast<long long>(i) * srcLength / dstLength);
+    }
+}
+
+} // namespace detail
+
+/**
+ * @class DetectionInput
+ * @brief Reusable face detector input built from one captured screen.
+ *
+ * Keep one instance per screen alive across detection cycles: the output buffer and the scratch accumulators are
+ * only reallocated when the screen or detection size changes.
+ */
+class DetectionInput {
+  public:
+    /**
+     * @brief Converts and downscales a captured frame into the detection buffer.
+     *
+     * @param frame Captured screen, `CV_8UC4` (BGRA) or `CV_8UC3` (BGR). Grey frames, other depths and frames
+     *              smaller than the detector input go through OpenCV; 16-bit frames are scaled to 8 bits and
+     *              floating point frames are taken to be in [0, 1].
+     * @param detectionSize Side of the square detector input (`videoCaffeDetectionSize`).
+     * @return The `detectionSize` x `detectionSize` BGR buffer, valid until the next call.
+     * @throws std::invalid_argument if the frame does not have 1, 3 or 4 channels.
+     */
+    const cv::Mat& prepare(const cv::Mat& frame, int detectionSize) {
+        source_ = frame;
+        buffer_.create(detectionSize, detectionSize, CV_8UC3);
+
+        if (frame.depth() != CV_8U || (frame.channels() != 3 && frame.channels() != 4) || frame.cols < detectionSize ||
+            frame.rows < detectionSize) {
+            cv::Mat bgr;
+            switch (frame.channels()) {
+            case 1:
+                cv::cvtColor(frame, bgr, cv::COLOR_GRAY2BGR);
+                break;
+            case 3:
+                bgr = frame;
+                break;
+            case 4:
+                cv::cvtColor(frame, bgr, cv::COLOR_BGRA2BGR);
+                break;
+            default:
+                throw std::invalid_argument("Unsupported capture frame with " + std::to_string(frame.channels()) +
+                                            " channels");
+            }
+            if (bgr.depth() != CV_8U) {
+                // Resizing into buffer_ would otherwise reallocate it with the source depth
+                cv::Mat converted;
+                bgr.convertTo(converted, CV_8U, depthScale(bgr.depth()));
+                bgr = converted;
+            }
+            cv::resize(bgr, buffer_, buffer_.size(), 0, 0, cv::INTER_AREA);
+            return buffer_;
+        }
+
+        const int channels     = frame.channels();
+        const size_t rowLength = static_cast<size_t>(frame.cols) * channels;
+        if (frame.cols != sourceSize_.width || frame.rows != sourceSize_.height || detectionSize != detectionSize_) {
+            detail::boxOffsets(frame.cols, detectionSize, xOffsets_);
+            detail::boxOffsets(frame.rows, detectionSize, yOffsets_);
+            sourceSize_    = frame.size();
+            detectionSize_ = detectionSize;
+        }
+        // One spare element for sumBox's last four-lane load on BGR rows; it is never accumulated into, so it stays
+        // zero across calls and rows are cleared below
+        if (rowAccumulator_.size() != rowLength + 1) {
+            rowAccumulator_.assign(rowLength + 1, 0u);
+        }
+
+        for (int oy = 0; oy < detectionSize; ++oy) {
+            std::fill(rowAccumulator_.begin(), rowAccumulator_.begin() + rowLength, 0u);
+            const int y0 = yOffsets_[oy];
+            const int y1 = yOffsets_[oy + 1];
+            for (int y = y0; y < y1; ++y) {
+                detail::accumulateRow(frame.ptr<std::uint8_t>(y), rowAccumulator_.data(), rowLength);
+            }
+
+            auto* out = buffer_.ptr<std::uint8_t>(oy);
+            for (int ox = 0; ox < detectionSize; ++ox) {
+                const int x0 = xOffsets_[ox];
+                const int x1 = xOffsets_[ox + 1];
+                std::uint32_t sums[3];
+                detail::sumBox(rowAccumulator_.data() + static_cast<size_t>(x0) * channels,
+                               static_cast<size_t>(x1 - x0),
+                               channels,
+                               sums);
+                const std::uint32_t area = static_cast<std::uint32_t>((y1 - y0) * (x1 - x0));
+                out[ox * 3 + 0]          = static_cast<std::uint8_t>((sums[0] + area / 2) / area);
+                out[ox * 3 + 1]          = static_cast<std::uint8_t>((sums[1] + area / 2) / area);
+                out[ox * 3 + 2]          = static_cast<std::uint8_t>((sums[2] + area / 2) / area);
+            }
+        }
+        return buffer_;
+    }
+
+    /// The detection buffer filled by the last call to `prepare`.
+    const cv::Mat& mat() const { return buffer_; }
+
+    /// Size of the frame passed to the last call to `prepare`.
+    cv::Size sourceSize() const { return source_.size(); }
+
+    /**
+     * @brief Maps a detector box in normalised `[0, 1]` coordinates onto the full resolution source frame.
+     */
+    cv::Rect toSourceRect(const cv::Rect2f& normalisedBox) const {
+        const cv::Rect box(cv::Point(cvRound(normalisedBox.x * source_.cols), cvRound(normalisedBox.y * source_.rows)),
+                           cv::Point(cvRound(normalisedBox.br().x * source_.cols),
+                                     cvRound(normalisedBox.br().y * source_.rows)));
+        return box & cv::Rect(0, 0, source_.cols, source_.rows);
+    }
+
+    /**
+     * @brief Extracts a full resolution BGR crop, converting only the pixels inside the box.
+     *
+     * @param normalisedBox Detector box in normalised `[0, 1]` coordinates.
+     * @return An owned 8-bit BGR copy of the region, or an empty matrix if the box lies outside the frame.
+     */
+    cv::Mat crop(const cv::Rect2f& normalisedBox) const {
+        const auto box = toSourceRect(normalisedBox);
+        cv::Mat out;
+        if (box.empty()) {
+            return out;
+        }
+        const cv::Mat region = source_(box);
+        if (region.channels() == 4) {
+            cv::cvtColor(region, out, cv::COLOR_BGRA2BGR);
+        } else if (region.channels() == 1) {
+            cv::cvtColor(region, out, cv::COLOR_GRAY2BGR);
+        } else {
+            region.copyTo(out);
+        }
+        if (out.depth() != CV_8U) {
+            out.convertTo(out, CV_8U, depthScale(out.depth()));
+        }
+        return out;
+    }
+
+    /// Drops the reference to the last source frame and frees the buffers.
+    void release() {
+        source_.release();
+        buffer_.release();
+        rowAccumulator_ = {};
+        xOffsets_.clear();
+        yOffsets_.clear();
+        sourceSize_    = {};
+        detectionSize_ = 0;
+    }
+
+  private:
+    /// Scale mapping a sample of the given depth onto 8 bits; floating point samples are taken to be in [0, 1].
+    static double depthScale(int depth) {
+        switch (depth) {
+        case CV_16U:
+        case CV_16S:
+            return 1.0 / 257.0;
+        case CV_32F:
+        case CV_64F:
+            return 255.0;
+        default:
+            return 1.0;
+        }
+    }
+
+    cv::Mat source_;
+    cv::Mat buffer_;
+    std::vector<std::uint32_t> rowAccumulator_;
+    std::vector<int> xOffsets_;
+    std::vector<int> yOffsets_;
+    cv::Size sourceSize_{};
+    int detectionSize_ = 0;
+};
+
+} // namespace edf::vision
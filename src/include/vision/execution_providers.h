@@ -0,0 +1,349 @@
+/**
+ * @file execution_providers.h
+ * @brief Ordered selection of ONNX Runtime CPU execution providers with fallback and benchmarking.
+ *
+ * The video classifier session is built with the first provider of the configured list
+ * (`videoExecutionProviders`) that is compiled into the ONNX Runtime build and accepts the graph. The default CPU
+ * provider is always tried last. Optionally every available provider is timed once on this machine and the fastest
+ * one is cached on disk, keyed by CPU and model, so later startups skip the benchmark.
+ */
+
+#pragma once
+
+#include "utils/logger.h"
+#include "utils/timer.h"
+
+#include "onnxruntime_cxx_api.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace edf::vision {
+
+/**
+ * @brief CPU execution providers the video classifier can run on.
+ */
+enum class ExecutionProvider {
+    Cpu,      ///< ONNX Runtime default CPU provider (MLAS)
+    Dnnl,     ///< oneDNN
+    OpenVino, ///< OpenVINO on the CPU device
+    Xnnpack   ///< XNNPACK
+};
+
+/// Name used in `videoExecutionProviders` and in logs.
+inline const char* toString(ExecutionProvider provider) {
+    switch (provider) {
+    case ExecutionProvider::Dnnl:
+        return "dnnl";
+    case ExecutionProvider::OpenVino:
+        return "openvino";
+    case ExecutionProvider::Xnnpack:
+        return "xnnpack";
+    default:
+        return "cpu";
+    }
+}
+
+/// Name ONNX Runtime registers the provider under.
+inline const char* ortName(ExecutionProvider provider) {
+    switch (provider) {
+    case ExecutionProvider::Dnnl:
+        return "DnnlExecutionProvider";
+    case ExecutionProvider::OpenVino:
+        return "OpenVINOExecutionProvider";
+    case ExecutionProvider::Xnnpack:
+        return "XnnpackExecutionProvider";
+    default:
+        return "CPUExecutionProvider";
+    }
+}
+
+inline std::optional<ExecutionProvider> executionProviderFromString(const std::string& name) {
+    for (auto provider :
+         {ExecutionProvider::Cpu, ExecutionProvider::Dnnl, ExecutionProvider::OpenVino, ExecutionProvider::Xnnpack}) {
+        if (name == toString(provider)) {
+            return provider;
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Parses a comma separated provider list such as `"openvino,dnnl,cpu"`.
+ *
+ * Unknown names are logged and skipped; the default CPU provider is appended if the list does not end with it.
+ */
+inline std::vector<ExecutionProvider> parseExecutionProviders(const std::string& list) {
+    std::vector<ExecutionProvider> providers;
+    std::stringstream stream{list};
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+        if (name.empty()) {
+            continue;
+        }
+        if (auto provider = executionProviderFromString(name)) {
+            if (std::find(providers.begin(), providers.end(), *provider) == providers.end()) {
+                providers.push_back(*provider);
+            }
+        } else {
+            LOG_WARN("Ignoring unknown execution provider '{}'", name);
+        }
+    }
+    providers.erase(std::remove(providers.begin(), providers.end(), ExecutionProvider::Cpu), providers.end());
+    providers.push_back(ExecutionProvider::Cpu);
+    return providers;
+}
+
+/// Whether the provider is compiled into the loaded ONNX Runtime.
+inline bool isAvailable(ExecutionProvider provider) {
+    static const auto available = Ort::GetAvailableProviders();
+    return std::find(available.begin(), available.end(), ortName(provider)) != available.end();
+}
+
+/**
+ * @brief Registers the provider on the session options (the default CPU provider needs nothing).
+ *
+ * @throws Ort::Exception if the provider cannot be created.
+ */
+inline void appendExecutionProvider(Ort::SessionOptions& options, ExecutionProvider provider) {
+    switch (provider) {
+    case ExecutionProvider::Dnnl: {
+        const auto& api                  = Ort::GetApi();
+        OrtDnnlProviderOptions* dnnlOpts = nullptr;
+        Ort::ThrowOnError(api.CreateDnnlProviderOptions(&dnnlOpts));
+        std::unique_ptr<OrtDnnlProviderOptions, decltype(api.ReleaseDnnlProviderOptions)> guard{
+            dnnlOpts, api.ReleaseDnnlProviderOptions};
+        Ort::ThrowOnError(api.SessionOptionsAppendExecutionProvider_Dnnl(options, dnnlOpts));
+        break;
+    }
+    case ExecutionProvider::OpenVino:
+        options.AppendExecutionProvider_OpenVINO_V2({{"device_type", "CPU"}});
+        break;
+    case ExecutionProvider::Xnnpack:
+        options.AppendExecutionProvider("XNNPACK", {});
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief ONNX Runtime logging callback forwarding to the application log.
+ *
+ * Pass it to the `Ort::Env` constructor. Node placement messages (which provider runs which nodes, logged by ONNX
+ * Runtime at verbose level while a session is created with `createSessionWithFallback`) are promoted to info so the
+ * log always shows where the graph actually runs; every other verbose or info message is dropped here.
+ */
+inline void ORT_API_CALL forwardOrtLog(void* /*param*/,
+                                       OrtLoggingLevel severity,
+                                       const char* category,
+                                       const char* /*logid*/,
+                                       const char* /*codeLocation*/,
+                                       const char* message) {
+    const std::string_view text{message};
+    if (text.find("Node placements") != std::string_view::npos || text.find("placed on") != std::string_view::npos ||
+        text.find(" Node(s) placed") != std::string_view::npos) {
+        LOG_INFO("[onnxruntime] {}", text);
+        return;
+    }
+    switch (severity) {
+    case ORT_LOGGING_LEVEL_FATAL:
+    case ORT_LOGGING_LEVEL_ERROR:
+        LOG_ERROR("[onnxruntime:{}] {}", category, text);
+        break;
+    case ORT_LOGGING_LEVEL_WARNING:
+        LOG_WARN("[onnxruntime:{}] {}", category, text);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Process wide ONNX Runtime environment.
+ *
+ * Created on first use with `forwardOrtLog`. The video classifier and the ONNX voice backend share it, so there is one
+ * ONNX Runtime logging and threading setup per process. It logs warnings and errors only: verbose messages, which
+ * include per-`Run` ones, are not even formatted. Only session creation in `createSessionWithFallback` is raised to
+ * verbose, for the node placements.
+ */
+inline Ort::Env& sharedOrtEnv() {
+    static Ort::Env env{ORT_LOGGING_LEVEL_WARNING, "edf", &forwardOrtLog, nullptr};
+    return env;
+}
+
+/**
+ * @brief Run options for sessions created with `createSessionWithFallback`.
+ *
+ * Without them a `Run` logs at the session's verbose creation level; these bring it back to warnings and errors.
+ */
+inline const Ort::RunOptions& classifierRunOptions() {
+    static const Ort::RunOptions options = [] {
+        Ort::RunOptions runOptions;
+        runOptions.SetRunLogSeverityLevel(ORT_LOGGING_LEVEL_WARNING);
+        return runOptions;
+    }();
+    return options;
+}
+
+/**
+ * @brief Reads and decrypts an `.onnx.encrypted` model into memory, as the video classifier is loaded.
+ *
+ * Defined next to `InferenceEngine::createOnnxSession`, which uses the same key. The plaintext only ever lives in the
+ * returned buffer; pass it to the `Ort::Session` constructor taking model data.
+ *
+ * @throws std::runtime_error if the file cannot be read or decrypted.
+ */
+std::vector<char> decryptModelFile(const std::filesystem::path& path);
+
+/// Builds session options ready for a provider to be appended.
+using SessionOptionsFactory = std::function<Ort::SessionOptions()>;
+/// Builds the session from options (loads/decrypts the model).
+using SessionFactory = std::function<Ort::Session(Ort::SessionOptions&)>;
+
+/**
+ * @brief Creates a session with the first provider in `order` that is available and accepts the graph.
+ *
+ * @param order Providers in order of preference, as returned by `parseExecutionProviders`.
+ * @param makeOptions Returns fresh session options (threading, optimisation level...).
+ * @param makeSession Creates the session from the options.
+ * @param selected Receives the provider the session was created with.
+ * The session is created at verbose log level so its node placements reach `forwardOrtLog`; run it with
+ * `classifierRunOptions()`.
+ *
+ * @throws Ort::Exception if no provider, including the default CPU one, can run the model.
+ */
+inline Ort::Session createSessionWithFallback(const std::vector<ExecutionProvider>& order,
+                                              const SessionOptionsFactory& makeOptions,
+                                              const SessionFactory& makeSession,
+                                              ExecutionProvider& selected) {
+    for (auto provider : order) {
+        if (provider != ExecutionProvider::Cpu && !isAvailable(provider)) {
+            LOG_INFO("Execution provider {} is not available in this build", toString(provider));
+            continue;
+        }
+        try {
+            auto options = makeOptions();
+            appendExecutionProvider(options, provider);
+            // Node placements are only reported at verbose level, and only while the session is created; runs go back
+            // to warnings through classifierRunOptions()
+            options.SetLogSeverityLevel(ORT_LOGGING_LEVEL_VERBOSE);
+            auto session = makeSession(options);
+            selected     = provider;
+            LOG_INFO("Video classifier session created with execution provider {}", toString(provider));
+            return session;
+        } catch (const Ort::Exception& e) {
+            if (provider == ExecutionProvider::Cpu) {
+                throw;
+            }
+            LOG_WARN("Execution provider {} rejected the model, falling back: {}", toString(provider), e.what());
+        }
+    }
+    auto options = makeOptions();
+    selected     = ExecutionProvider::Cpu;
+    return makeSession(options);
+}
+
+namespace detail {
+
+inline std::unordered_map<std::string, std::string> readProviderCache(const std::filesystem::path& cacheFile) {
+    std::unordered_map<std::string, std::string> entries;
+    std::ifstream in{cacheFile};
+    std::string line;
+    while (std::getline(in, line)) {
+        if (auto pos = line.rfind('='); pos != std::string::npos) {
+            entries[line.substr(0, pos)] = line.substr(pos + 1);
+        }
+    }
+    return entries;
+}
+
+inline void writeProviderCache(const std::filesystem::path& cacheFile,
+                               const std::unordered_map<std::string, std::string>& entries) {
+    std::ofstream out{cacheFile, std::ios::trunc};
+    for (const auto& [key, value] : entries) {
+        out << key << '=' << value << '\n';
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Picks the fastest available provider for this machine, benchmarking only on a cache miss.
+ *
+ * @param candidates Providers to consider, as returned by `parseExecutionProviders`.
+ * @param makeOptions Returns fresh session options.
+ * @param makeSession Creates the session from the options.
+ * @param runOnce Runs one classifier inference on a representative input.
+ * @param cacheFile File holding previous choices, one `key=provider` per line.
+ * @param cacheKey Identifies machine and model, e.g. CPU brand string plus model identifier.
+ * @param iterations Timed runs per provider after one warm-up run.
+ * @return The fastest provider, or the default CPU provider if nothing else could be benchmarked.
+ */
+inline ExecutionProvider selectFastestProvider(const std::vector<ExecutionProvider>& candidates,
+                                               const SessionOptionsFactory& makeOptions,
+                                               const SessionFactory& makeSession,
+                                               const std::function<void(Ort::Session&)>& runOnce,
+                                               const std::filesystem::path& cacheFile,
+                                               const std::string& cacheKey,
+                                               int iterations = 10) {
+    auto cache = detail::readProviderCache(cacheFile);
+    if (auto hit = cache.find(cacheKey); hit != cache.end()) {
+        if (auto provider = executionProviderFromString(hit->second);
+            provider && (*provider == ExecutionProvider::Cpu || isAvailable(*provider))) {
+            LOG_INFO("Using cached fastest execution provider {}", hit->second);
+            return *provider;
+        }
+    }
+
+    auto fastest    = ExecutionProvider::Cpu;
+    auto bestMillis = std::numeric_limits<double>::max();
+    for (auto provider : candidates) {
+        if (provider != ExecutionProvider::Cpu && !isAvailable(provider)) {
+            continue;
+        }
+        try {
+            auto options = makeOptions();
+            appendExecutionProvider(options, provider);
+            auto session = makeSession(options);
+            runOnce(session);
+            utils::Timer timer;
+            for (int i = 0; i < iterations; ++i) {
+                runOnce(session);
+            }
+            const auto millis =
+                std::chrono::duration<double, std::milli>(timer.elapsed()).count() / std::max(iterations, 1);
+            LOG_INFO("Execution provider {}: {:.2f} ms per inference", toString(provider), millis);
+            if (millis < bestMillis) {
+                bestMillis = millis;
+                fastest    = provider;
+            }
+        } catch (const Ort::Exception& e) {
+            LOG_WARN("Execution provider {} could not be benchmarked: {}", toString(provider), e.what());
+        }
+    }
+
+    cache[cacheKey] = toString(fastest);
+    try {
+        detail::writeProviderCache(cacheFile, cache);
+    } catch (const std::exception& e) {
+        LOG_WARN("Could not cache execution provider choice: {}", e.what());
+    }
+    LOG_INFO("Fastest execution provider on this machine: {}", toString(fastest));
+    return fastest;
+}
+
+} // namespace edf::vision
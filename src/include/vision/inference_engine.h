@@ -1,37 +1,101 @@
 #pragma once
 
+#ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 6269 26495 6294 6201)
+#endif
 #include "opencv2/dnn.hpp"
 #include "opencv2/opencv.hpp"
+#ifdef _MSC_VER
 #pragma warning(pop)
+#endif
 #include "onnxruntime_cxx_api.h"
 
+#include "detection_lib_version.h"
+#include "vision/execution_providers.h"
+#include "vision/precision.h"
+#include "vision/ssd_decode.h"
+
+#include <filesystem>
+
 namespace edf::vision {
+
+/**
+ * @brief How the video classifier session is built.
+ */
+struct OnnxRuntimeOptions {
+    /// Resolved with `resolvePrecision`
+    Precision precision = Precision::FP32;
+    /// Tried in order, see `parseExecutionProviders`
+    std::vector<ExecutionProvider> providers{ExecutionProvider::Cpu};
+    /// Pick the fastest of `providers` on this machine instead of the first one that works
+    bool benchmarkProviders = false;
+    /// Where the benchmarked choice is cached
+    std::filesystem::path providerCacheFile;
+    /// Intra-op threads, normally `ThreadPolicy::inferenceThreads()`; 0 keeps the ONNX Runtime default
+    int intraOpThreads = 0;
+};
+
 class InferenceEngine {
     cv::dnn::Net dnn_net_;
     // Ort::Session session_;
-    Ort::Env env_{nullptr};
+    // Environment shared with the ONNX voice backend, see sharedOrtEnv()
+    Ort::Env& env_ = sharedOrtEnv();
     Ort::MemoryInfo memory_info_{nullptr};
 
     Ort::Session session_{nullptr};
 
+    // Precision the loaded classifier runs in; inputs/outputs are converted through the buffers below when reduced
+    Precision precision_ = Precision::FP32;
+    std::vector<std::uint16_t> reducedInput_;
+    std::vector<float> convertedOutput_;
+
+    // Execution provider the classifier session was created with
+    ExecutionProvider executionProvider_ = ExecutionProvider::Cpu;
+
+    SsdDecoder ssdDecoder_;
+
     void loadingCaffeModel(const std::string& dirPath);
 
-    void createOnnxSession(const std::string& dirPath, const std::string& modelFileName);
+    void createOnnxSession(const std::string& dirPath,
+                           const std::string& modelFileName,
+                           const OnnxRuntimeOptions& options);
     void createOnnxMemoryInfo();
     bool checkCaffeModelIsLoaded();
-    void getOnnxSession(const std::string& dirPath, const std::string& modelFileName);
+    void getOnnxSession(const std::string& dirPath, const std::string& modelFileName, const OnnxRuntimeOptions& options);
     void getOnnxMemoryInfo();
-    void createSessionEnv();
     void loadCaffeModel(const std::string& dirPath);
 
   public:
     static constexpr int onnx_inf_len = 512;
+    // Runs the classifier with classifierRunOptions(), so inference logs at warning level (see sharedOrtEnv())
     std::vector<Ort::Value> runOnnxInference(cv::Mat& mat_onnx_blob);
     cv::Mat runCaffeInference(cv::Mat mat_desktop_orig, int inputSizeHeight);
 
-    void setupOnnxRuntime(const std::string& dirPath, const std::string& modelFileName);
+    // Filters and suppresses the `1x1xNx7` output of `runCaffeInference`; the result is reused by the next call
+    const DetectionBoxes& decodeFaces(const cv::Mat& detections, float confidence, float iou, size_t maxFaces) {
+        const auto rows = static_cast<size_t>(detections.total() / SsdDecoder::rowLength);
+        return ssdDecoder_.decode(detections.ptr<float>(), rows, confidence, iou, maxFaces);
+    }
+
+    // Loads the `options.precision` variant of the model when it exists and verdicts on the reference crops match
+    // fp32, otherwise the fp32 model. The session runs on the first (or fastest) usable `options.providers` entry.
+    void setupOnnxRuntime(const std::string& dirPath,
+                          const std::string& modelFileName,
+                          const OnnxRuntimeOptions& options = {});
+    Precision precision() const { return precision_; }
+    ExecutionProvider executionProvider() const { return executionProvider_; }
+
+    // Returns an output of `runOnnxInference` as floats, converting from the reduced precision when needed
+    const float* outputAsFloat(Ort::Value& output) {
+        if (precision_ == Precision::FP32) {
+            return output.GetTensorMutableData<float>();
+        }
+        const auto count = output.GetTensorTypeAndShapeInfo().GetElementCount();
+        convertedOutput_.resize(count);
+        convertToFloat(output.GetTensorData<std::uint16_t>(), convertedOutput_.data(), count, precision_);
+        return convertedOutput_.data();
+    }
     void setupCaffeModel(const std::string& dirPath);
     void releaseResources();
 };
@@ -0,0 +1,284 @@
+/**
+ * @file precision.h
+ * @brief Runtime selection of reduced precision (FP16/BF16) inference for the video classifier.
+ *
+ * Reduced precision is opt-in through `videoInferencePrecision` and only used when the CPU can convert to and from
+ * the reduced format natively and a converted model (`<name>.fp16.onnx...`, `<name>.bf16.onnx...`) ships next to the
+ * fp32 one. Anything else falls back to fp32.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace edf::vision {
+
+/**
+ * @brief Numeric formats the video classifier can run in.
+ */
+enum class Precision {
+    FP32, ///< Default, always available
+    FP16, ///< IEEE half precision, needs F16C
+    BF16  ///< bfloat16, needs AVX512-BF16 or AMX-BF16
+};
+
+/**
+ * @brief Reduced precision capabilities of the CPU the process runs on.
+ */
+struct CpuPrecisionSupport {
+    bool f16c       = false; ///< Hardware fp32 <-> fp16 conversion (and the OS saves AVX state)
+    bool avx512Bf16 = false; ///< AVX512 BF16 dot products (and the OS saves AVX-512 state)
+    bool amxBf16    = false; ///< AMX tiles with BF16 support
+};
+
+namespace detail {
+
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+inline void cpuid(int leaf, int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+    int out[4];
+    __cpuidex(out, leaf, subleaf);
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<unsigned int>(out[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+inline unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax = 0, edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+} // namespace detail
+
+/**
+ * @brief Queries CPUID once and caches the result.
+ */
+inline const CpuPrecisionSupport& cpuPrecisionSupport() {
+    static const CpuPrecisionSupport support = [] {
+        CpuPrecisionSupport s;
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        unsigned int regs[4] = {};
+        detail::cpuid(0, 0, regs);
+        const unsigned int maxLeaf = regs[0];
+        if (maxLeaf < 1) {
+            return s;
+        }
+        detail::cpuid(1, 0, regs);
+        const bool osxsave = (regs[2] >> 27) & 1;
+        if (!osxsave) {
+            return s;
+        }
+        const auto xcr0     = detail::xgetbv0();
+        const bool avxState = (xcr0 & 0x6) == 0x6;
+        const bool zmmState = (xcr0 & 0xe6) == 0xe6;
+        const bool amxState = ((xcr0 >> 17) & 0x3) == 0x3;
+        s.f16c              = avxState && ((regs[2] >> 29) & 1);
+        if (maxLeaf >= 7) {
+            detail::cpuid(7, 0, regs);
+            s.amxBf16 = amxState && ((regs[3] >> 22) & 1);
+            detail::cpuid(7, 1, regs);
+            s.avx512Bf16 = zmmState && ((regs[0] >> 5) & 1);
+        }
+#endif
+        return s;
+    }();
+    return support;
+}
+
+/**
+ * @brief Resolves the configured precision against what the CPU supports.
+ *
+ * @param requested One of `"fp32"`, `"fp16"`, `"bf16"` or `"auto"` (fastest supported). Unknown values mean fp32.
+ */
+inline Precision resolvePrecision(const std::string& requested) {
+    const auto& cpu = cpuPrecisionSupport();
+    const bool bf16 = cpu.avx512Bf16 || cpu.amxBf16;
+    if (requested == "bf16" || requested == "auto") {
+        if (bf16) {
+            return Precision::BF16;
+        }
+    }
+    if (requested == "fp16" || requested == "auto") {
+        if (cpu.f16c) {
+            return Precision::FP16;
+        }
+    }
+    return Precision::FP32;
+}
+
+/// Short lowercase name of a precision, as used in config values, model file names and logs.
+inline const char* toString(Precision precision) {
+    switch (precision) {
+    case Precision::FP16:
+        return "fp16";
+    case Precision::BF16:
+        return "bf16";
+    default:
+        return "fp32";
+    }
+}
+
+/**
+ * @brief Name of the converted model for a precision: `model.onnx.encrypted` -> `model.fp16.onnx.encrypted`.
+ */
+inline std::string modelFileNameFor(const std::string& modelFileName, Precision precision) {
+    if (precision == Precision::FP32) {
+        return modelFileName;
+    }
+    const auto pos = modelFileName.find(".onnx");
+    const auto tag = std::string{"."} + toString(precision);
+    return pos == std::string::npos ? modelFileName + tag : modelFileName.substr(0, pos) + tag + modelFileName.substr(pos);
+}
+
+/// Converts one float to IEEE half precision, rounding to nearest even.
+inline std::uint16_t floatToHalf(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const std::uint32_t sign = (bits >> 16) & 0x8000u;
+    const std::uint32_t abs  = bits & 0x7fffffffu;
+    if (abs >= 0x7f800000u) { // inf or nan
+        return static_cast<std::uint16_t>(sign | 0x7c00u | (abs > 0x7f800000u ? 0x200u : 0u));
+    }
+    if (abs >= 0x477ff000u) { // rounds to >= 65520, overflows
+        return static_cast<std::uint16_t>(sign | 0x7c00u);
+    }
+    if (abs < 0x38800000u) { // subnormal half or zero
+        float magnitude;
+        std::memcpy(&magnitude, &abs, sizeof(magnitude));
+        return static_cast<std::uint16_t>(sign | static_cast<std::uint32_t>(std::nearbyint(magnitude * 16777216.0f)));
+    }
+    const std::uint32_t rounded = abs + 0xfffu + ((abs >> 13) & 1u) - (112u << 23);
+    return static_cast<std::uint16_t>(sign | (rounded >> 13));
+}
+
+/// Converts one IEEE half to float.
+inline float halfToFloat(std::uint16_t half) {
+    const std::uint32_t sign     = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+    const std::uint32_t exponent = (half >> 10) & 0x1fu;
+    const std::uint32_t mantissa = half & 0x3ffu;
+    std::uint32_t bits;
+    if (exponent == 0x1f) {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    } else if (exponent == 0) {
+        const float magnitude = static_cast<float>(mantissa) / 16777216.0f;
+        std::memcpy(&bits, &magnitude, sizeof(bits));
+        bits |= sign;
+    } else {
+        bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// Converts one float to bfloat16, rounding to nearest even and keeping NaNs quiet.
+inline std::uint16_t floatToBf16(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7fffffffu) > 0x7f800000u) {
+        return static_cast<std::uint16_t>((bits >> 16) | 0x40u);
+    }
+    bits += 0x7fffu + ((bits >> 16) & 1u);
+    return static_cast<std::uint16_t>(bits >> 16);
+}
+
+/// Converts one bfloat16 to float.
+inline float bf16ToFloat(std::uint16_t bf16) {
+    const std::uint32_t bits = static_cast<std::uint32_t>(bf16) << 16;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Converts a float buffer into the given reduced precision, eight lanes at a time when F16C is available.
+ */
+inline void convertFromFloat(const float* src, std::uint16_t* dst, size_t count, Precision precision) {
+    size_t i = 0;
+    if (precision == Precision::FP16) {
+#if defined(_MSC_VER) || defined(__F16C__)
+        if (cpuPrecisionSupport().f16c) {
+            for (; i + 8 <= count; i += 8) {
+                const __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), half);
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            dst[i] = floatToHalf(src[i]);
+        }
+    } else {
+        for (; i < count; ++i) {
+            dst[i] = floatToBf16(src[i]);
+        }
+    }
+}
+
+/**
+ * @brief Converts a reduced precision buffer back into floats.
+ */
+inline void convertToFloat(const std::uint16_t* src, float* dst, size_t count, Precision precision) {
+    size_t i = 0;
+    if (precision == Precision::FP16) {
+#if defined(_MSC_VER) || defined(__F16C__)
+        if (cpuPrecisionSupport().f16c) {
+            for (; i + 8 <= count; i += 8) {
+                const __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(half));
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            dst[i] = halfToFloat(src[i]);
+        }
+    } else {
+        for (; i < count; ++i) {
+            dst[i] = bf16ToFloat(src[i]);
+        }
+    }
+}
+
+/**
+ * @brief Checks that reduced precision scores give the same verdicts as fp32 on a reference crop set.
+ *
+ * Run once after loading a reduced precision model; when it fails the engine reloads the fp32 model.
+ *
+ * @param reference fp32 fake probabilities of the reference crops.
+ * @param candidate Reduced precision fake probabilities of the same crops, in the same order.
+ * @param threshold The configured `ProbFakeThreshold`; a crop is fake when its score is above it.
+ * @return true if every crop falls on the same side of the threshold.
+ */
+inline bool verdictsAgree(const std::vector<float>& reference, const std::vector<float>& candidate, float threshold) {
+    if (reference.size() != candidate.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < reference.size(); ++i) {
+        if ((reference[i] > threshold) != (candidate[i] > threshold)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace edf::vision
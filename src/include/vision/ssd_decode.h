@@ -0,0 +1,237 @@
+/**
+ * @file ssd_decode.h
+ * @brief Decoding of the face detector (SSD) output with vectorised non-maximum suppression.
+ *
+ * The SSD forward pass returns a `1x1xNx7` tensor of `[imageId, label, confidence, x0, y0, x1, y1]` rows. With
+ * several screens this is thousands of rows per cycle. Rows are filtered on confidence into structure-of-arrays boxes,
+ * dropping boxes without area. The confidences sit 7 floats apart, so the filter gathers them with scalar loads and
+ * only compares four at a time; it is bound by those loads, not by the comparison. Suppression is the vectorised part:
+ * it runs on the surviving boxes sorted by score, computing the overlap of one kept box against four candidates at a
+ * time from contiguous arrays and recording suppressed boxes in a bitmask. All buffers live in a `SsdDecoder` that is
+ * reused across cycles, so steady-state decoding does not allocate.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#ifndef EDF_VISION_SSE2
+#define EDF_VISION_SSE2 1
+#endif
+#endif
+
+namespace edf::vision {
+
+/**
+ * @brief Boxes in normalised `[0, 1]` coordinates, stored as structure of arrays.
+ */
+struct DetectionBoxes {
+    std::vector<float> x0, y0, x1, y1, score;
+
+    size_t size() const { return score.size(); }
+
+    bool empty() const { return score.empty(); }
+
+    void clear() {
+        x0.clear();
+        y0.clear();
+        x1.clear();
+        y1.clear();
+        score.clear();
+    }
+
+    void reserve(size_t count) {
+        x0.reserve(count);
+        y0.reserve(count);
+        x1.reserve(count);
+        y1.reserve(count);
+        score.reserve(count);
+    }
+
+    void push_back(float left, float top, float right, float bottom, float confidence) {
+        x0.push_back(left);
+        y0.push_back(top);
+        x1.push_back(right);
+        y1.push_back(bottom);
+        score.push_back(confidence);
+    }
+};
+
+/**
+ * @class SsdDecoder
+ * @brief Turns raw SSD rows into suppressed face boxes using reused buffers.
+ */
+class SsdDecoder {
+  public:
+    static constexpr size_t rowLength = 7; ///< `[imageId, label, confidence, x0, y0, x1, y1]`
+
+    /**
+     * @brief Keeps the rows whose confidence is above `threshold`, clamping their boxes to `[0, 1]`.
+     *
+     * Boxes left without area by the clamp (or emitted inverted by the detector) are dropped: they cannot be cropped
+     * and would take a `maxBoxes` slot in `suppress`.
+     *
+     * @param rows Pointer to the first row of the detection tensor.
+     * @param count Number of rows.
+     * @param threshold Minimum confidence (exclusive).
+     * @return The candidates, valid until the next call.
+     */
+    const DetectionBoxes& filter(const float* rows, size_t count, float threshold) {
+        candidates_.clear();
+        candidates_.reserve(count);
+        size_t i = 0;
+#ifdef EDF_VISION_SSE2
+        const __m128 limit = _mm_set1_ps(threshold);
+        for (; i + 4 <= count; i += 4) {
+            const float* r    = rows + i * rowLength;
+            const __m128 conf = _mm_setr_ps(r[2], r[2 + rowLength], r[2 + 2 * rowLength], r[2 + 3 * rowLength]);
+            int mask          = _mm_movemask_ps(_mm_cmpgt_ps(conf, limit));
+            while (mask != 0) {
+                const int lane = lowestSetBit(mask);
+                mask &= mask - 1;
+                append(r + lane * rowLength);
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            const float* r = rows + i * rowLength;
+            if (r[2] > threshold) {
+                append(r);
+            }
+        }
+        return candidates_;
+    }
+
+    /**
+     * @brief Greedy non-maximum suppression over the last `filter` result.
+     *
+     * @param iouThreshold Boxes overlapping a higher scored kept box by more than this are dropped.
+     * @param maxBoxes Stop once this many boxes are kept (`videoMaxNumberFaces`); 0 means no limit.
+     * @return Kept boxes sorted by descending score, valid until the next call.
+     */
+    const DetectionBoxes& suppress(float iouThreshold, size_t maxBoxes = 0) {
+        kept_.clear();
+        const size_t count = candidates_.size();
+        if (count == 0) {
+            return kept_;
+        }
+
+        order_.resize(count);
+        std::iota(order_.begin(), order_.end(), 0u);
+        std::stable_sort(order_.begin(), order_.end(), [this](std::uint32_t a, std::uint32_t b) {
+            return candidates_.score[a] > candidates_.score[b];
+        });
+        sorted_.clear();
+        sorted_.reserve(count);
+        for (auto index : order_) {
+            sorted_.push_back(candidates_.x0[index],
+                              candidates_.y0[index],
+                              candidates_.x1[index],
+                              candidates_.y1[index],
+                              candidates_.score[index]);
+        }
+        area_.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            area_[i] = (sorted_.x1[i] - sorted_.x0[i]) * (sorted_.y1[i] - sorted_.y0[i]);
+        }
+        suppressed_.assign((count + 63) / 64, 0);
+
+        for (size_t i = 0; i < count; ++i) {
+            if (suppressed_[i / 64] & (std::uint64_t{1} << (i % 64))) {
+                continue;
+            }
+            kept_.push_back(sorted_.x0[i], sorted_.y0[i], sorted_.x1[i], sorted_.y1[i], sorted_.score[i]);
+            if (maxBoxes != 0 && kept_.size() == maxBoxes) {
+                break;
+            }
+            markOverlaps(i, iouThreshold);
+        }
+        return kept_;
+    }
+
+    /// `filter` followed by `suppress`.
+    const DetectionBoxes&
+    decode(const float* rows, size_t count, float threshold, float iouThreshold, size_t maxBoxes = 0) {
+        filter(rows, count, threshold);
+        return suppress(iouThreshold, maxBoxes);
+    }
+
+  private:
+    DetectionBoxes candidates_;
+    DetectionBoxes sorted_;
+    DetectionBoxes kept_;
+    std::vector<std::uint32_t> order_;
+    std::vector<float> area_;
+    std::vector<std::uint64_t> suppressed_;
+
+    static int lowestSetBit(int mask) {
+        int bit = 0;
+        while (!(mask & (1 << bit))) {
+            ++bit;
+        }
+        return bit;
+    }
+
+    void append(const float* row) {
+        auto clamp01       = [](float v) { return std::min(std::max(v, 0.0f), 1.0f); };
+        const float left   = clamp01(row[3]);
+        const float top    = clamp01(row[4]);
+        const float right  = clamp01(row[5]);
+        const float bottom = clamp01(row[6]);
+        // Also rejects NaN coordinates, which fail every comparison
+        if (!(right > left && bottom > top)) {
+            return;
+        }
+        candidates_.push_back(left, top, right, bottom, row[2]);
+    }
+
+    // Sets the suppression bit of every box after `i` that overlaps box `i` by more than `iouThreshold`
+    void markOverlaps(size_t i, float iouThreshold) {
+        const size_t count = sorted_.size();
+        size_t j           = i + 1;
+#ifdef EDF_VISION_SSE2
+        const __m128 ax0  = _mm_set1_ps(sorted_.x0[i]);
+        const __m128 ay0  = _mm_set1_ps(sorted_.y0[i]);
+        const __m128 ax1  = _mm_set1_ps(sorted_.x1[i]);
+        const __m128 ay1  = _mm_set1_ps(sorted_.y1[i]);
+        const __m128 aa   = _mm_set1_ps(area_[i]);
+        const __m128 thr  = _mm_set1_ps(iouThreshold);
+        const __m128 zero = _mm_setzero_ps();
+        for (; j + 4 <= count; j += 4) {
+            const __m128 left   = _mm_max_ps(ax0, _mm_loadu_ps(&sorted_.x0[j]));
+            const __m128 top    = _mm_max_ps(ay0, _mm_loadu_ps(&sorted_.y0[j]));
+            const __m128 right  = _mm_min_ps(ax1, _mm_loadu_ps(&sorted_.x1[j]));
+            const __m128 bottom = _mm_min_ps(ay1, _mm_loadu_ps(&sorted_.y1[j]));
+            const __m128 w      = _mm_max_ps(zero, _mm_sub_ps(right, left));
+            const __m128 h      = _mm_max_ps(zero, _mm_sub_ps(bottom, top));
+            const __m128 inter  = _mm_mul_ps(w, h);
+            const __m128 uni    = _mm_sub_ps(_mm_add_ps(aa, _mm_loadu_ps(&area_[j])), inter);
+            // inter / union > thr  <=>  inter > thr * union (union > 0 whenever inter > 0)
+            int mask = _mm_movemask_ps(_mm_cmpgt_ps(inter, _mm_mul_ps(thr, uni)));
+            while (mask != 0) {
+                const int lane = lowestSetBit(mask);
+                mask &= mask - 1;
+                const size_t k = j + lane;
+                suppressed_[k / 64] |= std::uint64_t{1} << (k % 64);
+            }
+        }
+#endif
+        for (; j < count; ++j) {
+            const float left   = std::max(sorted_.x0[i], sorted_.x0[j]);
+            const float top    = std::max(sorted_.y0[i], sorted_.y0[j]);
+            const float right  = std::min(sorted_.x1[i], sorted_.x1[j]);
+            const float bottom = std::min(sorted_.y1[i], sorted_.y1[j]);
+            const float inter  = std::max(0.0f, right - left) * std::max(0.0f, bottom - top);
+            if (inter > iouThreshold * (area_[i] + area_[j] - inter)) {
+                suppressed_[j / 64] |= std::uint64_t{1} << (j % 64);
+            }
+        }
+    }
+};
+
+} // namespace edf::vision
@@ -12,10 +12,14 @@
 
 #include "utils/logger.h"
 
+#ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 6269 26495 6294 6201)
+#endif
 #include "opencv2/opencv.hpp"
+#ifdef _MSC_VER
 #pragma warning(pop)
+#endif
 
 namespace edf::vision::utils {
 
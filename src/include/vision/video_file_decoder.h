@@ -0,0 +1,297 @@
+/**
+ * @file video_file_decoder.h
+ * @brief Parallel decoding of recorded video files for offline scanning.
+ *
+ * A single `cv::VideoCapture` decodes on one core, which caps a file scan far below what face detection could take.
+ * The file is therefore split into contiguous frame ranges, each decoded by its own thread with its own capture
+ * seeked to the start of its range. Decoded frames meet in one bounded queue, so memory stays flat when detection is
+ * the slower side. Frames arrive grouped by range rather than in file order; each carries its index and position.
+ *
+ * The ranges are cut from the container's frame count, which is only an estimate for variable frame rate, fragmented
+ * or re-muxed files. The last range therefore always decodes to the end of the file.
+ */
+
+#pragma once
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 6269 26495 6294 6201)
+#endif
+#include "opencv2/opencv.hpp"
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace edf::vision {
+
+/**
+ * @brief Stream properties reported by the container.
+ */
+struct VideoFileInfo {
+    double fps           = 0.0;
+    long long frameCount = 0; ///< Container estimate; 0 when the container does not report it
+    cv::Size frameSize{};
+};
+
+/**
+ * @brief Opens `path` once to read its properties.
+ *
+ * @return Unset if OpenCV cannot open the file.
+ */
+inline std::optional<VideoFileInfo> probeVideoFile(const std::filesystem::path& path) {
+    cv::VideoCapture capture(path.string());
+    if (!capture.isOpened()) {
+        return std::nullopt;
+    }
+    VideoFileInfo info;
+    info.fps        = capture.get(cv::CAP_PROP_FPS);
+    info.frameCount = std::max(0LL, static_cast<long long>(capture.get(cv::CAP_PROP_FRAME_COUNT)));
+    info.frameSize  = {static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH)),
+                       static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT))};
+    return info;
+}
+
+/**
+ * @brief One decoded frame of a file.
+ */
+struct DecodedFrame {
+    long long index   = 0;   ///< Frame number in the file
+    double positionMs = 0.0; ///< Presentation time reported by the capture (`CAP_PROP_POS_MSEC`)
+    cv::Mat pixels;          ///< BGR
+    size_t range      = 0;   ///< Decoder range the frame came from
+};
+
+/**
+ * @class ParallelVideoDecoder
+ * @brief Decodes a file on several threads and hands the frames to one consumer.
+ */
+class ParallelVideoDecoder {
+  public:
+    /**
+     * @param threads Decoder threads; files without a frame count are decoded on one.
+     * @param stride Keep every `stride`-th frame; the others are grabbed but not converted.
+     * @param capacity Decoded frames buffered ahead of the consumer.
+     * @param firstFrame Frames before this one are skipped, e.g. a `resumeFrame()` checkpoint of an earlier run.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    ParallelVideoDecoder(const std::filesystem::path& path,
+                         size_t threads,
+                         int stride           = 1,
+                         size_t capacity      = 32,
+                         long long firstFrame = 0)
+        : path_(path), stride_(std::max(stride, 1)), capacity_(std::max<size_t>(capacity, 1)) {
+        const auto info = probeVideoFile(path);
+        if (!info) {
+            throw std::runtime_error("Could not open video file " + path.string());
+        }
+        info_ = *info;
+
+        // A checkpoint past the estimated count is kept: the file may well have more frames than its container says
+        first_                = std::max(0LL, firstFrame);
+        const long long count = std::max(0LL, info_.frameCount - first_);
+        const size_t segments = count == 0 ? 1 : std::clamp<size_t>(threads, 1, count);
+        for (size_t i = 0; i < segments; ++i) {
+            const auto parts = static_cast<long long>(segments);
+            Range range;
+            range.begin     = first_ + count * static_cast<long long>(i) / parts;
+            range.end       = i + 1 == segments ? std::numeric_limits<long long>::max()
+                                                : first_ + count * static_cast<long long>(i + 1) / parts;
+            range.delivered = range.begin;
+            ranges_.push_back(range);
+        }
+        active_ = segments;
+        decoders_.reserve(segments);
+        for (size_t i = 0; i < segments; ++i) {
+            decoders_.emplace_back([this, i] { decode(i); });
+        }
+    }
+
+    ParallelVideoDecoder(const ParallelVideoDecoder&)            = delete;
+    ParallelVideoDecoder& operator=(const ParallelVideoDecoder&) = delete;
+
+    ~ParallelVideoDecoder() {
+        stop();
+        for (auto& decoder : decoders_) {
+            decoder.join();
+        }
+    }
+
+    const VideoFileInfo& info() const { return info_; }
+
+    /// Frames that will be delivered when the rest of the file decodes, estimated from the container; 0 if unknown.
+    long long expectedFrames() const {
+        if (info_.frameCount == 0) {
+            return 0;
+        }
+        // Multiples of stride_ in [first_, frameCount)
+        return std::max(0LL, (info_.frameCount + stride_ - 1) / stride_ - (first_ + stride_ - 1) / stride_);
+    }
+
+    /**
+     * @brief Waits for the next decoded frame.
+     *
+     * @return false once every range is decoded, or after `stop`.
+     * @throws The first error raised by a decoder thread (e.g. `cv::Exception`), once the other ranges are done.
+     */
+    bool next(DecodedFrame& frame) {
+        std::unique_lock lock{mutex_};
+        frameReady_.wait(lock, [this] { return stopping_ || !frames_.empty() || active_ == 0; });
+        if (stopping_ || frames_.empty()) {
+            if (error_) {
+                std::rethrow_exception(std::exchange(error_, nullptr));
+            }
+            return false;
+        }
+        frame = std::move(frames_.front());
+        frames_.pop_front();
+        auto& range     = ranges_[frame.range];
+        range.delivered = frame.index + 1;
+        --range.queued;
+        lock.unlock();
+        spaceFree_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Checkpoint for resuming: every frame before the returned index has been returned by `next`.
+     *
+     * Ranges are decoded side by side, so frames already delivered from later ranges are decoded again on resume;
+     * consumers that record per-frame results must replace, not append, the results of those frames. Once every range
+     * is finished the file has been decoded to its end, and the returned index is its real frame count.
+     */
+    long long resumeFrame() const {
+        std::lock_guard lock{mutex_};
+        for (const auto& range : ranges_) {
+            if (!range.finished || range.queued != 0) {
+                return range.delivered;
+            }
+        }
+        // A range cut past the real end of the file grabs nothing; the furthest frame grabbed ends the file
+        long long end = first_;
+        for (const auto& range : ranges_) {
+            end = std::max(end, range.reached);
+        }
+        return end;
+    }
+
+    /// Makes the decoders and `next` return early.
+    void stop() {
+        {
+            std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+        spaceFree_.notify_all();
+        frameReady_.notify_all();
+    }
+
+  private:
+    struct Range {
+        long long begin     = 0;
+        long long end       = 0;
+        long long delivered = 0; ///< One past the last frame handed to the consumer
+        long long reached   = 0; ///< One past the last frame grabbed, 0 if none
+        size_t queued       = 0; ///< Frames of the range waiting in frames_
+        bool finished       = false;
+    };
+
+    /**
+     * @brief Positions `capture` so that its next grab returns frame `target` or an earlier one.
+     *
+     * OpenCV's frame seek is not frame-accurate on every container, so the frame it landed on is read back. An earlier
+     * frame is fine, the caller grabs forward to `target`; a later one, or a failed seek, reopens the file and decodes
+     * from the first frame.
+     *
+     * @return Index of the frame the next grab returns.
+     */
+    static long long seek(cv::VideoCapture& capture, const std::filesystem::path& path, long long target) {
+        if (target == 0) {
+            return 0;
+        }
+        if (capture.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(target))) {
+            const auto landed = static_cast<long long>(capture.get(cv::CAP_PROP_POS_FRAMES));
+            if (landed >= 0 && landed <= target) {
+                return landed;
+            }
+        }
+        capture.open(path.string());
+        return 0;
+    }
+
+    void decode(size_t rangeIndex) {
+        const long long begin = ranges_[rangeIndex].begin;
+        const long long end   = ranges_[rangeIndex].end;
+        long long reached     = 0;
+        bool finished         = false;
+        try {
+            cv::VideoCapture capture(path_.string());
+            for (long long index = seek(capture, path_, begin); index < end && capture.grab(); ++index) {
+                reached = index + 1;
+                if (index < begin || index % stride_ != 0) {
+                    continue;
+                }
+                DecodedFrame frame;
+                frame.range      = rangeIndex;
+                frame.index      = index;
+                frame.positionMs = capture.get(cv::CAP_PROP_POS_MSEC);
+                if (!capture.retrieve(frame.pixels) || frame.pixels.empty()) {
+                    continue;
+                }
+                std::unique_lock lock{mutex_};
+                spaceFree_.wait(lock, [this] { return stopping_ || frames_.size() < capacity_; });
+                if (stopping_) {
+                    break;
+                }
+                frames_.push_back(std::move(frame));
+                ++ranges_[rangeIndex].queued;
+                lock.unlock();
+                frameReady_.notify_one();
+            }
+            std::lock_guard lock{mutex_};
+            finished = !stopping_;
+        } catch (...) {
+            std::lock_guard lock{mutex_};
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        {
+            std::lock_guard lock{mutex_};
+            ranges_[rangeIndex].finished = finished;
+            ranges_[rangeIndex].reached  = reached;
+            --active_;
+        }
+        frameReady_.notify_all();
+    }
+
+    const std::filesystem::path path_;
+    const long long stride_;
+    const size_t capacity_;
+    VideoFileInfo info_;
+    long long first_ = 0;
+
+    mutable std::mutex mutex_;
+    std::condition_variable frameReady_;
+    std::condition_variable spaceFree_;
+    std::deque<DecodedFrame> frames_;
+    std::vector<Range> ranges_;
+    size_t active_ = 0;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+
+    std::vector<std::thread> decoders_;
+};
+
+} // namespace edf::vision
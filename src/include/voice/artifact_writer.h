@@ -0,0 +1,247 @@
+/**
+ * @file artifact_writer.h
+ * @brief Background, compressed storage of flagged voice windows.
+ *
+ * A window classified as `InferenceEngineVoice::DeepFake` carries its samples to the result path. Instead of writing
+ * them uncompressed on the detection thread, the samples are moved into a queue and a worker encodes them with
+ * libsndfile as FLAC or Ogg/Opus (lossy, much smaller). The file is written under a temporary name, synced to disk
+ * and renamed, and only then is the `db::Voice` row inserted. A row therefore always points to a complete file, even
+ * after a crash, and the upload path never sees a partial artifact.
+ *
+ * The verdict matters more than its audio: if Opus cannot encode a window (e.g. an unsupported sample rate) it is
+ * stored as FLAC instead, and if no file can be stored at all the row is still inserted, with an empty
+ * `artifact_location` and the reason in `artifact_error`.
+ */
+
+#pragma once
+
+#include "database.h"
+#include "utils/logger.h"
+
+#ifdef _WIN32
+#define ENABLE_SNDFILE_WINDOWS_PROTOTYPES 1
+#endif
+#include "sndfile.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace edf::voice {
+
+/**
+ * @brief Encoding of stored voice artifacts.
+ */
+enum class ArtifactFormat {
+    Flac, ///< 24-bit PCM: transparent for capture audio (float samples are quantised below -140 dBFS)
+    Opus  ///< Ogg/Opus, 5-10x smaller; the capture rate must be one Opus supports (8/12/16/24/48 kHz)
+};
+
+inline ArtifactFormat artifactFormatFromString(std::string_view name) {
+    return name == "opus" ? ArtifactFormat::Opus : ArtifactFormat::Flac;
+}
+
+inline const char* fileExtension(ArtifactFormat format) { return format == ArtifactFormat::Opus ? ".opus" : ".flac"; }
+
+/**
+ * @class VoiceArtifactWriter
+ * @brief Encodes flagged windows on a worker thread and records them once they are durable.
+ */
+class VoiceArtifactWriter {
+  public:
+    struct Stats {
+        std::uint64_t written      = 0; ///< Artifacts stored and recorded
+        std::uint64_t fallbacks    = 0; ///< Of those, stored as FLAC because the configured format failed
+        std::uint64_t failed       = 0; ///< Verdicts stored without audio (no file could be written) or not at all
+        std::uint64_t rawBytes     = 0; ///< Size the float samples would have had uncompressed
+        std::uint64_t encodedBytes = 0; ///< Size of the stored files
+    };
+
+    /**
+     * @param database Receives one `db::Voice` row per stored artifact, from the worker thread (`db::Database`
+     *                 serialises its callers); must outlive the writer.
+     * @param compressionLevel 0 (fastest/largest) to 1 (slowest/smallest), see SFC_SET_COMPRESSION_LEVEL.
+     */
+    VoiceArtifactWriter(db::Database& database, ArtifactFormat format, double compressionLevel = 0.5)
+        : database_(database), format_(format), compressionLevel_(compressionLevel), worker_([this] { work(); }) {}
+
+    VoiceArtifactWriter(const VoiceArtifactWriter&)            = delete;
+    VoiceArtifactWriter& operator=(const VoiceArtifactWriter&) = delete;
+
+    /// Stores everything still queued, then stops the worker.
+    ~VoiceArtifactWriter() {
+        {
+            std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        worker_.join();
+    }
+
+    /**
+     * @brief Queues mono `samples` for storage at `pathWithoutExtension` plus the format's extension.
+     *
+     * `row.artifact_location` is filled in by the worker; the row is inserted only after the file is on disk.
+     */
+    void write(std::vector<float>&& samples, int rate, std::filesystem::path pathWithoutExtension, db::Voice row) {
+        {
+            std::lock_guard lock{mutex_};
+            jobs_.push_back({std::move(samples), rate, std::move(pathWithoutExtension), std::move(row)});
+        }
+        wakeup_.notify_one();
+    }
+
+    /// Blocks until every queued artifact has been stored (or has failed), e.g. before uploading to S3.
+    void flush() {
+        std::unique_lock lock{mutex_};
+        idle_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+    }
+
+    Stats stats() const {
+        return {written_.load(), fallbacks_.load(), failed_.load(), rawBytes_.load(), encodedBytes_.load()};
+    }
+
+  private:
+    struct Job {
+        std::vector<float> samples;
+        int rate;
+        std::filesystem::path path;
+        db::Voice row;
+    };
+
+    void work() {
+        std::unique_lock lock{mutex_};
+        while (true) {
+            wakeup_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) {
+                return;
+            }
+            Job job = std::move(jobs_.front());
+            jobs_.pop_front();
+            busy_ = true;
+            lock.unlock();
+            store(job);
+            lock.lock();
+            busy_ = false;
+            if (jobs_.empty()) {
+                idle_.notify_all();
+            }
+        }
+    }
+
+    void store(Job& job) {
+        std::string error = storeAs(job, format_);
+        if (!error.empty() && format_ != ArtifactFormat::Flac) {
+            LOG_WARN("Storing voice artifact {} as FLAC instead: {}", job.path.string(), error);
+            error = storeAs(job, ArtifactFormat::Flac);
+            fallbacks_ += error.empty() ? 1 : 0;
+        }
+        if (!error.empty()) {
+            LOG_ERROR("Recording voice verdict without its audio: {}", error);
+            job.row.artifact_location.clear();
+            job.row.artifact_error = error;
+        }
+        // A failed insert (locked or full database, schema mismatch) must not take the capture process down with it
+        try {
+            database_.insert(job.row);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Could not record voice verdict {}: {}", job.row.artifact_location, e.what());
+            ++failed_;
+            return;
+        }
+        if (error.empty()) {
+            ++written_;
+        } else {
+            ++failed_;
+        }
+    }
+
+    // Writes the artifact durably and sets `row.artifact_location`; returns the error, empty on success
+    std::string storeAs(Job& job, ArtifactFormat format) {
+        auto target = job.path;
+        target += fileExtension(format);
+        auto partial = target;
+        partial += ".partial";
+
+        std::error_code ec;
+        std::string error = encode(job, format, partial);
+        if (!error.empty()) {
+            std::filesystem::remove(partial, ec);
+            return error;
+        }
+        // The rename is atomic, so a crash leaves either no file or a complete one, never a truncated artifact
+        std::filesystem::rename(partial, target, ec);
+        if (ec) {
+            error = "Could not move " + target.string() + " into place: " + ec.message();
+            std::filesystem::remove(partial, ec);
+            return error;
+        }
+        rawBytes_ += job.samples.size() * sizeof(float);
+        if (const auto bytes = std::filesystem::file_size(target, ec); !ec) {
+            encodedBytes_ += bytes;
+        }
+        job.row.artifact_location = target.string();
+        return {};
+    }
+
+    std::string encode(const Job& job, ArtifactFormat format, const std::filesystem::path& path) const {
+        SF_INFO info{};
+        info.samplerate = job.rate;
+        info.channels   = 1;
+        info.format =
+            format == ArtifactFormat::Opus ? (SF_FORMAT_OGG | SF_FORMAT_OPUS) : (SF_FORMAT_FLAC | SF_FORMAT_PCM_24);
+#ifdef _WIN32
+        SNDFILE* file = sf_wchar_open(path.c_str(), SFM_WRITE, &info);
+#else
+        SNDFILE* file = sf_open(path.c_str(), SFM_WRITE, &info);
+#endif
+        if (file == nullptr) {
+            return "Could not create " + path.string() + ": " + sf_strerror(nullptr);
+        }
+        double level = compressionLevel_;
+        sf_command(file, SFC_SET_COMPRESSION_LEVEL, &level, sizeof(level));
+        // Samples are in [-1, 1]; clip rather than wrap anything the model input let through above full scale
+        int clip = SF_TRUE;
+        sf_command(file, SFC_SET_CLIPPING, &clip, sizeof(clip));
+
+        const auto frames = static_cast<sf_count_t>(job.samples.size());
+        std::string error;
+        if (sf_writef_float(file, job.samples.data(), frames) != frames) {
+            error = "Could not encode " + path.string() + ": " + sf_strerror(file);
+        }
+        sf_write_sync(file); // flushes to the device (fsync / FlushFileBuffers)
+        if (sf_close(file) != 0 && error.empty()) {
+            error = "Could not finish " + path.string();
+        }
+        return error;
+    }
+
+    db::Database& database_;
+    const ArtifactFormat format_;
+    const double compressionLevel_;
+
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable idle_;
+    std::deque<Job> jobs_;
+    bool busy_     = false;
+    bool stopping_ = false;
+
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> fallbacks_{0};
+    std::atomic<std::uint64_t> failed_{0};
+    std::atomic<std::uint64_t> rawBytes_{0};
+    std::atomic<std::uint64_t> encodedBytes_{0};
+
+    std::thread worker_; // last, so it starts after everything it uses is constructed
+};
+
+} // namespace edf::voice
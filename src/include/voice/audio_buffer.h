@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <vector>
 
 namespace edf::voice {
@@ -8,6 +10,9 @@ struct AudioBuffer {
     unsigned long rate   = 0;
     size_t channels      = 1;
     int bytes_per_sample = 4;
+    bool is_float        = true; // 4-byte samples are float32 (the usual WASAPI mix format), int32 otherwise
+
+    std::chrono::steady_clock::time_point captured_at{}; // when the chunk was queued, see capture_backpressure.h
 
     size_t num_samples() const { return samples.size() / channels / bytes_per_sample; }
 };
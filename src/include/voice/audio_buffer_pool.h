@@ -0,0 +1,76 @@
+/**
+ * @file audio_buffer_pool.h
+ * @brief Recycles `AudioBuffer` sample storage between the capture and the inference thread.
+ *
+ * Captured chunks travel from the capture thread to the inference thread through an SPSC queue. Once scored, the
+ * buffers travel back through a second SPSC queue in the opposite direction and are refilled by the next capture, so
+ * in steady state no sample storage is allocated or freed. Both directions are lock free.
+ */
+
+#pragma once
+
+#include "voice/audio_buffer.h"
+
+#include "readerwriterqueue/readerwriterqueue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace edf::voice {
+
+/**
+ * @class AudioBufferPool
+ * @brief Return channel of empty buffers; `acquire` on the capture thread, `release` on the inference thread.
+ */
+class AudioBufferPool {
+  public:
+    struct Stats {
+        std::uint64_t allocated = 0; ///< Buffers created because none was waiting to be reused
+        std::uint64_t reused    = 0; ///< Buffers handed out again with their storage
+        std::uint64_t dropped   = 0; ///< Buffers freed because the return queue was full
+        size_t available        = 0; ///< Buffers currently waiting to be reused
+    };
+
+    /// `capacity` bounds how many empty buffers are kept; match the capture queue size.
+    explicit AudioBufferPool(size_t capacity = 1024) : free_(capacity) {}
+
+    AudioBufferPool(const AudioBufferPool&)            = delete;
+    AudioBufferPool& operator=(const AudioBufferPool&) = delete;
+
+    /// Returns an empty buffer, reusing the storage of a released one when available.
+    AudioBuffer acquire() {
+        AudioBuffer buffer;
+        if (free_.try_dequeue(buffer)) {
+            reused_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            allocated_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return buffer;
+    }
+
+    /// Hands a consumed buffer back; its samples are cleared but their capacity is kept.
+    void release(AudioBuffer&& buffer) {
+        buffer.samples.clear();
+        buffer.captured_at = {};
+        // try_enqueue never grows the queue, which bounds the pool to its initial capacity
+        if (!free_.try_enqueue(std::move(buffer))) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Stats stats() const {
+        return {allocated_.load(std::memory_order_relaxed),
+                reused_.load(std::memory_order_relaxed),
+                dropped_.load(std::memory_order_relaxed),
+                free_.size_approx()};
+    }
+
+  private:
+    moodycamel::ReaderWriterQueue<AudioBuffer> free_;
+    std::atomic<std::uint64_t> allocated_{0};
+    std::atomic<std::uint64_t> reused_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+} // namespace edf::voice
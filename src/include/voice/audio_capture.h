@@ -1,4 +1,5 @@
 #pragma once
+#include "detection_lib_version.h"
 #include "voice/audio_buffer.h"
 
 #define NOMINMAX
@@ -6,6 +7,7 @@
 #include "Mmdeviceapi.h"
 #include "audioclient.h"
 
+#include <chrono>
 #include <memory>
 
 namespace edf::voice {
@@ -46,6 +48,12 @@ class AudioCapture {
 
     AudioBuffer read(int durationSecs);
 
+    // Same as read(durationSecs) but fills `out`, reusing its sample storage (see AudioBufferPool)
+    void read(int durationSecs, AudioBuffer& out);
+
+    // Sub-second chunks for streaming scoring (see HopScheduler); `duration` is rounded to whole capture packets
+    void read(std::chrono::milliseconds duration, AudioBuffer& out);
+
     ~AudioCapture() { stop(); }
 };
 } // namespace edf::voice
@@ -0,0 +1,314 @@
+/**
+ * @file audio_normalizer.h
+ * @brief Converts captured audio of any WASAPI mix format into mono float at the voice model's sample rate.
+ *
+ * WASAPI mix formats vary between machines (44.1/48/96 kHz, float32 or int16/24, stereo up to 7.1). The normaliser
+ * converts and downmixes in one vectorised pass, then resamples with a polyphase windowed-sinc filter whose phase
+ * coefficients are computed once per rate pair. Filter history and phase carry over between chunks, so chunk
+ * boundaries are seamless.
+ */
+
+#pragma once
+
+#include "voice/audio_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#ifndef EDF_VOICE_SSE2
+#define EDF_VOICE_SSE2 1
+#endif
+#endif
+
+namespace edf::voice {
+
+namespace detail {
+
+/// Sums `count` floats of `a * b`, four lanes at a time.
+inline float dot(const float* a, const float* b, size_t count) {
+    size_t i  = 0;
+    float sum = 0.0f;
+#ifdef EDF_VOICE_SSE2
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+#endif
+    for (; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/// Zeroth order modified Bessel function of the first kind, for the Kaiser window.
+inline double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50 && term > 1e-12 * sum; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * @brief Converts interleaved samples to float and averages the channels into `out` (one value per frame).
+ */
+inline void downmixToMono(const AudioBuffer& in, std::vector<float>& out) {
+    const size_t channels = std::max<size_t>(in.channels, 1);
+    const size_t frames   = in.num_samples();
+    out.resize(frames);
+    const float gain = 1.0f / static_cast<float>(channels);
+    const auto* raw  = in.samples.data();
+
+    if (in.bytes_per_sample == 4 && in.is_float) {
+        const auto* src = reinterpret_cast<const float*>(raw);
+        size_t frame    = 0;
+#ifdef EDF_VOICE_SSE2
+        if (channels == 2) {
+            const __m128 half = _mm_set1_ps(0.5f);
+            for (; frame + 4 <= frames; frame += 4) {
+                const __m128 a = _mm_loadu_ps(src + frame * 2);     // L0 R0 L1 R1
+                const __m128 b = _mm_loadu_ps(src + frame * 2 + 4); // L2 R2 L3 R3
+                const __m128 l = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                const __m128 r = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(out.data() + frame, _mm_mul_ps(_mm_add_ps(l, r), half));
+            }
+        }
+#endif
+        for (; frame < frames; ++frame) {
+            float sum = 0.0f;
+            for (size_t c = 0; c < channels; ++c) {
+                sum += src[frame * channels + c];
+            }
+            out[frame] = sum * gain;
+        }
+        return;
+    }
+
+    if (in.bytes_per_sample == 2) {
+        const auto* src   = reinterpret_cast<const std::int16_t*>(raw);
+        const float scale = gain / 32768.0f;
+        size_t frame      = 0;
+#ifdef EDF_VOICE_SSE2
+        if (channels == 2) {
+            const __m128 s = _mm_set1_ps(scale);
+            for (; frame + 4 <= frames; frame += 4) {
+                const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + frame * 2)); // 4 frames
+                // madd sums each (L, R) int16 pair into one int32 lane
+                const __m128i sums = _mm_madd_epi16(px, _mm_set1_epi16(1));
+                _mm_storeu_ps(out.data() + frame, _mm_mul_ps(_mm_cvtepi32_ps(sums), s));
+            }
+        }
+#endif
+        for (; frame < frames; ++frame) {
+            std::int32_t sum = 0;
+            for (size_t c = 0; c < channels; ++c) {
+                sum += src[frame * channels + c];
+            }
+            out[frame] = static_cast<float>(sum) * scale;
+        }
+        return;
+    }
+
+    if (in.bytes_per_sample == 3) {
+        const float scale = gain / 8388608.0f;
+        for (size_t frame = 0; frame < frames; ++frame) {
+            std::int32_t sum = 0;
+            for (size_t c = 0; c < channels; ++c) {
+                const auto* p = raw + (frame * channels + c) * 3;
+                // Place the 24 bits at the top of an int32 and shift back to sign-extend
+                sum += static_cast<std::int32_t>((static_cast<std::uint32_t>(p[0]) << 8) |
+                                                 (static_cast<std::uint32_t>(p[1]) << 16) |
+                                                 (static_cast<std::uint32_t>(p[2]) << 24)) >>
+                       8;
+            }
+            out[frame] = static_cast<float>(sum) * scale;
+        }
+        return;
+    }
+
+    if (in.bytes_per_sample == 4) {
+        const auto* src   = reinterpret_cast<const std::int32_t*>(raw);
+        const float scale = gain / 2147483648.0f;
+        for (size_t frame = 0; frame < frames; ++frame) {
+            double sum = 0.0;
+            for (size_t c = 0; c < channels; ++c) {
+                sum += src[frame * channels + c];
+            }
+            out[frame] = static_cast<float>(sum) * scale;
+        }
+        return;
+    }
+
+    out.clear();
+}
+
+} // namespace detail
+
+/**
+ * @class PolyphaseResampler
+ * @brief Streaming rational resampler (`outRate / inRate = L / M`) with a Kaiser windowed-sinc prototype filter.
+ */
+class PolyphaseResampler {
+  public:
+    /**
+     * @param inRate Input sample rate in Hz.
+     * @param outRate Output sample rate in Hz.
+     * @param tapsPerPhase Filter length per phase at unity ratio; longer is sharper and slower. Scaled by the
+     *                     decimation factor when downsampling so the filter covers the same span of output samples,
+     *                     and rounded up to a multiple of 4.
+     */
+    PolyphaseResampler(unsigned long inRate, unsigned long outRate, size_t tapsPerPhase = 32)
+        : inRate_(inRate), outRate_(outRate) {
+        taps_     = (std::max<size_t>(tapsPerPhase, 4) + 3) / 4 * 4;
+        position_ = taps_ - 1;
+        if (inRate == 0 || outRate == 0 || inRate == outRate) {
+            return;
+        }
+        const auto divisor = std::gcd(inRate, outRate);
+        up_                = outRate / divisor;
+        down_              = inRate / divisor;
+        taps_              = (taps_ * ((down_ + up_ - 1) / up_) + 3) / 4 * 4;
+        position_          = taps_ - 1;
+
+        // Prototype low-pass at the upsampled rate, cut below the lower Nyquist frequency
+        const size_t length = taps_ * up_;
+        const double cutoff = 0.5 * 0.92 / static_cast<double>(std::max(up_, down_));
+        const double beta   = 8.0;
+        const double centre = (static_cast<double>(length) - 1.0) / 2.0;
+        const double norm   = detail::besselI0(beta);
+        std::vector<double> prototype(length);
+        for (size_t n = 0; n < length; ++n) {
+            const double t    = static_cast<double>(n) - centre;
+            const double sinc = t == 0.0 ? 1.0 : std::sin(2.0 * pi * cutoff * t) / (2.0 * pi * cutoff * t);
+            const double r    = t / (centre + 1.0);
+            prototype[n] = 2.0 * cutoff * sinc * detail::besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / norm;
+        }
+
+        // Split into phases, reversed so each output is a contiguous dot product over the history, and normalise
+        // every phase to unity DC gain
+        bank_.assign(up_ * taps_, 0.0f);
+        for (size_t phase = 0; phase < up_; ++phase) {
+            double sum = 0.0;
+            for (size_t k = 0; k < taps_; ++k) {
+                sum += prototype[k * up_ + phase];
+            }
+            for (size_t k = 0; k < taps_; ++k) {
+                bank_[phase * taps_ + (taps_ - 1 - k)] = static_cast<float>(prototype[k * up_ + phase] / sum);
+            }
+        }
+        history_.assign(taps_ - 1, 0.0f);
+    }
+
+    unsigned long inRate() const { return inRate_; }
+
+    unsigned long outRate() const { return outRate_; }
+
+    /// Output delay introduced by the filter, in input samples: the centre of the prototype, which need not fall on
+    /// an input sample.
+    double latency() const {
+        return up_ == down_ ? 0.0 : (static_cast<double>(taps_ * up_) - 1.0) / (2.0 * static_cast<double>(up_));
+    }
+
+    /**
+     * @brief Resamples the next chunk, appending the produced samples to `out`.
+     */
+    void process(std::span<const float> in, std::vector<float>& out) {
+        if (up_ == down_) {
+            out.insert(out.end(), in.begin(), in.end());
+            return;
+        }
+        work_.resize(history_.size() + in.size());
+        std::memcpy(work_.data(), history_.data(), history_.size() * sizeof(float));
+        std::memcpy(work_.data() + history_.size(), in.data(), in.size() * sizeof(float));
+
+        out.reserve(out.size() + (in.size() * up_) / down_ + 1);
+        while (position_ < work_.size()) {
+            out.push_back(detail::dot(&bank_[phase_ * taps_], &work_[position_ + 1 - taps_], taps_));
+            phase_ += down_;
+            position_ += phase_ / up_;
+            phase_ %= up_;
+        }
+
+        const size_t keep = taps_ - 1;
+        std::memcpy(history_.data(), work_.data() + work_.size() - keep, keep * sizeof(float));
+        position_ -= work_.size() - keep;
+    }
+
+    /// Forgets the filter history, e.g. after a capture gap.
+    void reset() {
+        std::fill(history_.begin(), history_.end(), 0.0f);
+        position_ = taps_ - 1;
+        phase_    = 0;
+    }
+
+  private:
+    static constexpr double pi = 3.14159265358979323846;
+
+    unsigned long inRate_;
+    unsigned long outRate_;
+    size_t up_   = 1;
+    size_t down_ = 1;
+    size_t taps_ = 0;
+    std::vector<float> bank_;    // up_ phases of taps_ reversed coefficients
+    std::vector<float> history_; // last taps_ - 1 input samples
+    std::vector<float> work_;    // history_ followed by the current chunk
+    size_t position_ = 0; // index in work_ of the newest sample of the next output
+    size_t phase_    = 0;
+};
+
+/**
+ * @class AudioNormalizer
+ * @brief Turns captured `AudioBuffer`s into a mono float stream at the model sample rate.
+ */
+class AudioNormalizer {
+  public:
+    explicit AudioNormalizer(unsigned long modelRate, size_t tapsPerPhase = 32)
+        : modelRate_(modelRate), tapsPerPhase_(tapsPerPhase) {}
+
+    /**
+     * @brief Converts, downmixes and resamples one captured chunk.
+     *
+     * The resampler is rebuilt (and its state reset) when the capture rate changes.
+     *
+     * @return Mono samples at the model rate, valid until the next call.
+     */
+    std::span<const float> process(const AudioBuffer& in) {
+        detail::downmixToMono(in, mono_);
+        if (!resampler_ || resampler_->inRate() != in.rate) {
+            resampler_.emplace(in.rate, modelRate_, tapsPerPhase_);
+        }
+        output_.clear();
+        resampler_->process(mono_, output_);
+        return output_;
+    }
+
+    /// Forgets the resampler history, e.g. after a capture gap.
+    void reset() {
+        if (resampler_) {
+            resampler_->reset();
+        }
+    }
+
+    unsigned long modelRate() const { return modelRate_; }
+
+  private:
+    const unsigned long modelRate_;
+    const size_t tapsPerPhase_;
+    std::optional<PolyphaseResampler> resampler_;
+    std::vector<float> mono_;
+    std::vector<float> output_;
+};
+
+} // namespace edf::voice
@@ -0,0 +1,213 @@
+/**
+ * @file audio_source.h
+ * @brief Platform independent audio sources feeding the voice capture queue.
+ *
+ * `runVoiceDetection` consumes `AudioBuffer`s from a queue, and on Windows the WASAPI loopback capture fills it. The
+ * sources here fill the same queue from WAV/FLAC files (libsndfile) or from raw PCM on a pipe. That lets the voice path
+ * run on Linux hosts, in reproducible performance runs and over recorded calls. Chunks are delivered either at the
+ * pace of the audio (as live capture would) or as fast as the consumer keeps up.
+ */
+
+#pragma once
+
+#include "utils/logger.h"
+#include "voice/audio_buffer.h"
+#include "voice/audio_buffer_pool.h"
+#include "voice/capture_backpressure.h"
+
+#include "readerwriterqueue/readerwriterqueue.h"
+#ifdef _WIN32
+#define ENABLE_SNDFILE_WINDOWS_PROTOTYPES 1
+#endif
+#include "sndfile.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace edf::voice {
+
+/**
+ * @class AudioSource
+ * @brief Produces interleaved audio chunks until the stream ends.
+ */
+class AudioSource {
+  public:
+    virtual ~AudioSource() = default;
+
+    /**
+     * @brief Fills `out` with up to `duration` of audio, reusing its sample storage.
+     *
+     * @return false once the stream is exhausted and `out` is empty.
+     */
+    virtual bool read(std::chrono::milliseconds duration, AudioBuffer& out) = 0;
+
+    virtual unsigned long rate() const = 0;
+
+    virtual size_t channels() const = 0;
+};
+
+/**
+ * @class SndFileSource
+ * @brief WAV, FLAC or any other container libsndfile reads, delivered as float32 interleaved samples.
+ */
+class SndFileSource : public AudioSource {
+  public:
+    /**
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    explicit SndFileSource(const std::filesystem::path& path) {
+#ifdef _WIN32
+        file_.reset(sf_wchar_open(path.c_str(), SFM_READ, &info_));
+#else
+        file_.reset(sf_open(path.c_str(), SFM_READ, &info_));
+#endif
+        if (!file_) {
+            throw std::runtime_error("Cannot open audio file " + path.string() + ": " + sf_strerror(nullptr));
+        }
+        LOG_DEBUG("Opened {} ({} Hz, {} channels, {} frames)",
+                  path.string(),
+                  info_.samplerate,
+                  info_.channels,
+                  info_.frames);
+    }
+
+    bool read(std::chrono::milliseconds duration, AudioBuffer& out) override {
+        const auto frames    = static_cast<sf_count_t>(duration.count()) * info_.samplerate / 1000;
+        out.rate             = rate();
+        out.channels         = channels();
+        out.bytes_per_sample = sizeof(float);
+        out.is_float         = true;
+        out.samples.resize(static_cast<size_t>(frames) * channels() * sizeof(float));
+        const auto got = sf_readf_float(file_.get(), reinterpret_cast<float*>(out.samples.data()), frames);
+        out.samples.resize(static_cast<size_t>(got) * channels() * sizeof(float));
+        return got > 0;
+    }
+
+    unsigned long rate() const override { return static_cast<unsigned long>(info_.samplerate); }
+
+    size_t channels() const override { return static_cast<size_t>(info_.channels); }
+
+    /// Total frames in the file.
+    sf_count_t frames() const { return info_.frames; }
+
+  private:
+    struct Closer {
+        void operator()(SNDFILE* file) const { sf_close(file); }
+    };
+
+    SF_INFO info_{};
+    std::unique_ptr<SNDFILE, Closer> file_;
+};
+
+/**
+ * @class PcmPipeSource
+ * @brief Headerless interleaved PCM read from a pipe or file, e.g. `ffmpeg -f s16le -` or stdin.
+ */
+class PcmPipeSource : public AudioSource {
+  public:
+    /**
+     * @param stream Open binary stream; not closed by the source.
+     * @param bytesPerSample 2, 3 or 4; 4 is float32 when `isFloat`, int32 otherwise.
+     */
+    PcmPipeSource(std::FILE* stream, unsigned long rate, size_t channels, int bytesPerSample, bool isFloat)
+        : stream_(stream), rate_(rate), channels_(channels), bytesPerSample_(bytesPerSample), isFloat_(isFloat) {}
+
+    bool read(std::chrono::milliseconds duration, AudioBuffer& out) override {
+        const size_t frameBytes = channels_ * static_cast<size_t>(bytesPerSample_);
+        const size_t frames     = static_cast<size_t>(duration.count()) * rate_ / 1000;
+        out.rate                = rate_;
+        out.channels            = channels_;
+        out.bytes_per_sample    = bytesPerSample_;
+        out.is_float            = isFloat_;
+        out.samples.resize(frames * frameBytes);
+        // A pipe may return short reads before the end; keep reading until the chunk is full or the stream ends
+        size_t got = 0;
+        while (got < out.samples.size()) {
+            const size_t n = std::fread(out.samples.data() + got, 1, out.samples.size() - got, stream_);
+            if (n == 0) {
+                break;
+            }
+            got += n;
+        }
+        out.samples.resize(got / frameBytes * frameBytes);
+        return !out.samples.empty();
+    }
+
+    unsigned long rate() const override { return rate_; }
+
+    size_t channels() const override { return channels_; }
+
+  private:
+    std::FILE* stream_;
+    const unsigned long rate_;
+    const size_t channels_;
+    const int bytesPerSample_;
+    const bool isFloat_;
+};
+
+/**
+ * @brief How fast `pumpAudioSource` delivers chunks.
+ */
+enum class Pacing {
+    Realtime, ///< One chunk per chunk duration, like live capture
+    Fast      ///< As fast as the queue accepts them, for batch scans and benchmarks
+};
+
+/**
+ * @brief Feeds `source` into `captureQueue` until it ends or `run` is cleared, the counterpart of
+ *        `edf::windows::voiceCapture` for non-WASAPI input.
+ *
+ * `run` is left alone when the source ends, so the caller can let the consumer drain the queue before stopping it.
+ *
+ * @param chunk Length of each `AudioBuffer`.
+ * @param bufferPool Buffers released by inference, refilled instead of allocating new ones when given.
+ * @param backpressure Chunks are enqueued through it when given, e.g. a `Block` policy so a file is scored in full
+ *                     without the queue growing; the consumer must dequeue through the same instance.
+ * @return true if the whole source was delivered, false if stopped early.
+ */
+inline bool pumpAudioSource(AudioSource& source,
+                            std::atomic_bool& run,
+                            std::chrono::milliseconds chunk,
+                            Pacing pacing,
+                            moodycamel::ReaderWriterQueue<AudioBuffer>& captureQueue,
+                            AudioBufferPool* bufferPool       = nullptr,
+                            CaptureBackpressure* backpressure = nullptr) {
+    using clock           = std::chrono::steady_clock;
+    const auto start      = clock::now();
+    std::uint64_t samples = 0; // frames delivered so far, to pace without drift
+    while (run) {
+        auto buffer = bufferPool ? bufferPool->acquire() : AudioBuffer{};
+        if (!source.read(chunk, buffer)) {
+            return true;
+        }
+        samples += buffer.num_samples();
+        if (pacing == Pacing::Realtime && source.rate() != 0) {
+            std::this_thread::sleep_until(start + std::chrono::microseconds(samples * 1000000 / source.rate()));
+        }
+        if (backpressure) {
+            if (!backpressure->enqueue(captureQueue, std::move(buffer), run)) {
+                return false;
+            }
+            continue;
+        }
+        if (pacing == Pacing::Fast) {
+            // The capture queue is sized for live capture; wait for room instead of failing
+            while (run && captureQueue.size_approx() >= captureQueue.max_capacity()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        if (!captureQueue.enqueue(std::move(buffer))) {
+            return false;
+        }
+    }
+    return false;
+}
+
+} // namespace edf::voice
@@ -0,0 +1,248 @@
+/**
+ * @file capture_backpressure.h
+ * @brief Overflow policies and latency metrics for the audio capture queue.
+ *
+ * `ReaderWriterQueue::enqueue` allocates a new block whenever the queue is full. If inference stalls (thermal
+ * throttling, a busy machine), memory grows without bound and every score is computed on audio further behind the
+ * call. A `CaptureBackpressure` sits on both ends of the queue and bounds its depth according to a policy:
+ *
+ * - `Block` (default): the capture thread waits for room. Nothing is skipped, but scores can lag behind real time.
+ *   The wait sleeps on a condition variable that the inference side signals as it takes chunks.
+ * - `DropOldest`: the inference thread discards the oldest queued chunks beyond the depth limit.
+ * - `Coalesce`: the inference thread merges everything queued into one chunk, trimmed to the newest audio, so one
+ *   inference catches up with the present.
+ *
+ * Depth and staleness (how old the audio being scored is) are tracked for diagnostics.
+ */
+
+#pragma once
+
+#include "voice/audio_buffer.h"
+#include "voice/audio_buffer_pool.h"
+
+#include "readerwriterqueue/readerwriterqueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+namespace edf::voice {
+
+/**
+ * @brief What happens when the capture queue is deeper than its limit.
+ */
+enum class OverflowPolicy { Block, DropOldest, Coalesce };
+
+/// Policy named by `voiceCaptureOverflowPolicy`; anything unknown keeps every chunk (`Block`).
+inline OverflowPolicy overflowPolicyFromString(std::string_view name) {
+    if (name == "drop_oldest") {
+        return OverflowPolicy::DropOldest;
+    }
+    return name == "coalesce" ? OverflowPolicy::Coalesce : OverflowPolicy::Block;
+}
+
+/**
+ * @class CaptureBackpressure
+ * @brief Policy-aware `enqueue` for the capture thread and `dequeue` for the inference thread, plus their metrics.
+ */
+class CaptureBackpressure {
+  public:
+    struct Metrics {
+        size_t depth            = 0; ///< Chunks queued when the last one was taken
+        size_t maxDepth         = 0;
+        std::uint64_t dropped   = 0; ///< Chunks discarded without being scored
+        std::uint64_t coalesced = 0; ///< Chunks merged into a later one
+        std::chrono::microseconds staleness{0}; ///< Age of the oldest audio in the last dequeued chunk
+        std::chrono::microseconds maxStaleness{0};
+        std::chrono::microseconds blocked{0}; ///< Time the capture thread spent waiting (Block)
+    };
+
+    /**
+     * @param maxDepth Chunks allowed in the queue before the policy applies.
+     * @param coalesceLimit Most recent audio kept when coalescing; older samples are discarded.
+     */
+    CaptureBackpressure(OverflowPolicy policy,
+                        size_t maxDepth,
+                        std::chrono::milliseconds coalesceLimit = std::chrono::milliseconds(4000)) {
+        configure(policy, maxDepth, coalesceLimit);
+    }
+
+    /**
+     * @brief Changes the policy, e.g. from the [voice] config when detection starts; safe while both sides run.
+     */
+    void configure(OverflowPolicy policy, size_t maxDepth, std::chrono::milliseconds coalesceLimit) {
+        policy_.store(policy, std::memory_order_relaxed);
+        maxDepth_.store(std::max<size_t>(maxDepth, 1), std::memory_order_relaxed);
+        coalesceLimitMs_.store(coalesceLimit.count(), std::memory_order_relaxed);
+    }
+
+    OverflowPolicy policy() const { return policy_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Capture side: stamps and queues `buffer`.
+     *
+     * @return false if `run` was cleared while blocking or the queue could not take the chunk.
+     */
+    bool enqueue(moodycamel::ReaderWriterQueue<AudioBuffer>& queue, AudioBuffer&& buffer, std::atomic_bool& run) {
+        buffer.captured_at    = std::chrono::steady_clock::now();
+        const size_t maxDepth = maxDepth_.load(std::memory_order_relaxed);
+        if (policy() == OverflowPolicy::Block && queue.size_approx() >= maxDepth) {
+            const auto start = std::chrono::steady_clock::now();
+            {
+                std::unique_lock lock{roomMutex_};
+                // `run` is cleared without a notification, so the wait wakes up now and then to look at it
+                while (run && queue.size_approx() >= maxDepth) {
+                    room_.wait_for(lock, std::chrono::milliseconds(50));
+                }
+            }
+            const auto waited = std::chrono::steady_clock::now() - start;
+            blockedUs_ += std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+            if (!run) {
+                return false;
+            }
+        }
+        // The inference side trims the queue for the other policies; enqueue still grows it rather than lose audio
+        // if the consumer has not caught up yet
+        return queue.enqueue(std::move(buffer));
+    }
+
+    /**
+     * @brief Inference side: takes the next chunk to score, applying the policy.
+     *
+     * @param pool Receives the storage of discarded or merged chunks when given.
+     * @return false if the queue was empty.
+     */
+    bool dequeue(moodycamel::ReaderWriterQueue<AudioBuffer>& queue, AudioBuffer& out, AudioBufferPool* pool = nullptr) {
+        const size_t depth    = queue.size_approx();
+        const size_t maxDepth = maxDepth_.load(std::memory_order_relaxed);
+        const auto policy     = this->policy();
+        if (!queue.try_dequeue(out)) {
+            return false;
+        }
+        if (policy == OverflowPolicy::DropOldest) {
+            // `out` is the oldest; swap it for a newer chunk while the rest is still over the limit
+            for (size_t queued = depth > 0 ? depth - 1 : 0; queued >= maxDepth; --queued) {
+                AudioBuffer newer;
+                if (!queue.try_dequeue(newer)) {
+                    break;
+                }
+                recycle(std::move(out), pool);
+                out = std::move(newer);
+                ++dropped_;
+            }
+        } else if (policy == OverflowPolicy::Coalesce && depth > maxDepth) {
+            coalesce(queue, out, pool);
+        } else if (policy == OverflowPolicy::Block) {
+            // Taking the lock orders this dequeue before the waiter's next look at the queue, so the wakeup is not
+            // lost between its check and its wait
+            {
+                std::lock_guard lock{roomMutex_};
+            }
+            room_.notify_one();
+        }
+        record(depth, out);
+        return true;
+    }
+
+    Metrics metrics() const {
+        Metrics m;
+        m.depth        = depth_.load(std::memory_order_relaxed);
+        m.maxDepth     = maxDepthSeen_.load(std::memory_order_relaxed);
+        m.dropped      = dropped_.load(std::memory_order_relaxed);
+        m.coalesced    = coalesced_.load(std::memory_order_relaxed);
+        m.staleness    = std::chrono::microseconds(stalenessUs_.load(std::memory_order_relaxed));
+        m.maxStaleness = std::chrono::microseconds(maxStalenessUs_.load(std::memory_order_relaxed));
+        m.blocked      = std::chrono::microseconds(blockedUs_.load(std::memory_order_relaxed));
+        return m;
+    }
+
+  private:
+    static void recycle(AudioBuffer&& buffer, AudioBufferPool* pool) {
+        if (pool) {
+            pool->release(std::move(buffer));
+        }
+    }
+
+    // Appends every queued chunk with the same format to `out`, keeping only the newest coalesce limit of audio
+    void coalesce(moodycamel::ReaderWriterQueue<AudioBuffer>& queue, AudioBuffer& out, AudioBufferPool* pool) {
+        AudioBuffer next;
+        while (const auto* front = queue.peek()) {
+            if (front->rate != out.rate || front->channels != out.channels ||
+                front->bytes_per_sample != out.bytes_per_sample || front->is_float != out.is_float) {
+                break;
+            }
+            queue.try_dequeue(next);
+            out.samples.insert(out.samples.end(), next.samples.begin(), next.samples.end());
+            out.captured_at = next.captured_at;
+            recycle(std::move(next), pool);
+            next = AudioBuffer{};
+            ++coalesced_;
+        }
+        const size_t frameBytes = out.channels * static_cast<size_t>(out.bytes_per_sample);
+        const auto limitMs      = static_cast<size_t>(coalesceLimitMs_.load(std::memory_order_relaxed));
+        const size_t keep       = limitMs * out.rate / 1000 * frameBytes;
+        if (keep != 0 && out.samples.size() > keep) {
+            out.samples.erase(out.samples.begin(), out.samples.end() - static_cast<std::ptrdiff_t>(keep));
+        }
+    }
+
+    void record(size_t depth, const AudioBuffer& out) {
+        depth_.store(depth, std::memory_order_relaxed);
+        if (depth > maxDepthSeen_.load(std::memory_order_relaxed)) {
+            maxDepthSeen_.store(depth, std::memory_order_relaxed);
+        }
+        if (out.captured_at == std::chrono::steady_clock::time_point{}) {
+            return;
+        }
+        // captured_at marks the end of the chunk; its first sample is older by the chunk's duration
+        const auto duration = std::chrono::microseconds(
+            out.rate == 0 ? 0 : static_cast<std::int64_t>(out.num_samples()) * 1000000 / out.rate);
+        const auto queued =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - out.captured_at);
+        const auto age = queued + duration;
+        stalenessUs_.store(age.count(), std::memory_order_relaxed);
+        if (age.count() > maxStalenessUs_.load(std::memory_order_relaxed)) {
+            maxStalenessUs_.store(age.count(), std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic<OverflowPolicy> policy_{OverflowPolicy::Block};
+    std::atomic<size_t> maxDepth_{1};
+    std::atomic<std::int64_t> coalesceLimitMs_{0};
+
+    std::atomic<size_t> depth_{0};
+    std::atomic<size_t> maxDepthSeen_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> coalesced_{0};
+    std::atomic<std::int64_t> stalenessUs_{0};
+    std::atomic<std::int64_t> maxStalenessUs_{0};
+    std::atomic<std::int64_t> blockedUs_{0};
+
+    // Signalled by dequeue under Block; the capture thread waits on it while the queue is full
+    std::mutex roomMutex_;
+    std::condition_variable room_;
+};
+
+/**
+ * @brief Both directions between capture and inference plus the overflow policy applied to the forward queue.
+ *
+ * Live capture applies the `[voice]` settings with `ApplicationController::configureVoiceCapture`; the defaults
+ * never drop audio.
+ */
+struct AudioCaptureChannel {
+    explicit AudioCaptureChannel(size_t capacity                        = 1024,
+                                 OverflowPolicy policy                  = OverflowPolicy::Block,
+                                 size_t maxDepth                        = 8,
+                                 std::chrono::milliseconds coalesceLimit = std::chrono::milliseconds(4000))
+        : queue(capacity), pool(capacity), backpressure(policy, maxDepth, coalesceLimit) {}
+
+    moodycamel::ReaderWriterQueue<AudioBuffer> queue;
+    AudioBufferPool pool;
+    CaptureBackpressure backpressure;
+};
+
+} // namespace edf::voice
@@ -0,0 +1,145 @@
+/**
+ * @file feature_cache.h
+ * @brief Incremental front end for overlapping voice windows.
+ *
+ * With a hop shorter than the window, consecutive windows share most of their audio frames, and a model that starts
+ * with framing/STFT/mel recomputes the same features on every run. When the voice graph can be split into a front-end
+ * subgraph (audio to per-frame features) and a classifier subgraph (feature frames to score), the front end only runs
+ * on the frames completed since the last hop and the features are kept in a ring. Each classifier input is then
+ * assembled from the cached frames.
+ */
+
+#pragma once
+
+#include "utils/ring_buffer.h"
+#include "voice/window_tensor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace edf::voice {
+
+/**
+ * @brief Where the voice SavedModel is split, and the framing of its front end.
+ *
+ * Operation names are looked up in the loaded graph, and the framing must match the exported front end; both come
+ * from the `[voice]` config. When an operation is missing or the framing is unset, the engine keeps running the
+ * whole graph on raw windows.
+ */
+struct FrontEndSplit {
+    std::string frontEndInput;    ///< Raw audio `[samples]` fed to the front end
+    std::string frontEndOutput;   ///< Feature frames `[frames, featureDim]`
+    std::string classifierInput;  ///< Feature window `[batch, windowFrames, featureDim]`
+    std::string classifierOutput; ///< Scores
+    size_t frameLength = 0;       ///< Samples per frame, e.g. 400 (25 ms at 16 kHz)
+    size_t frameShift  = 0;       ///< Samples between frame starts, e.g. 160 (10 ms at 16 kHz)
+    size_t featureDim  = 0;       ///< Values per frame, e.g. 80 mel bins
+};
+
+/**
+ * @class FeatureCache
+ * @brief Ring of feature frames, extended with only the frames completed by each new chunk of samples.
+ *
+ * The ring holds one classifier window plus `historyFrames` older frames, so a batch of overlapping windows whose
+ * oldest window ends `historyFrames` frames before the newest one is assembled entirely from cached frames.
+ */
+class FeatureCache {
+  public:
+    /**
+     * @brief Computes `frames` consecutive feature frames from `samples` into `features` (`frames * featureDim`).
+     *
+     * `samples` holds exactly `(frames - 1) * frameShift + frameLength` samples.
+     */
+    using FrontEnd = std::function<void(std::span<const float> samples, size_t frames, std::span<float> features)>;
+
+    /**
+     * @param windowFrames Feature frames in one classifier window.
+     * @param historyFrames Frames kept before the newest window: the largest `endFrames` passed to `load`, i.e. the
+     *                      frames spanned by the hops or chunks of the largest batch.
+     * @throws std::invalid_argument unless `0 < frameShift <= frameLength` and `featureDim > 0`.
+     */
+    FeatureCache(size_t frameLength,
+                 size_t frameShift,
+                 size_t featureDim,
+                 size_t windowFrames,
+                 size_t historyFrames = 0)
+        : frameLength_(frameLength), frameShift_(frameShift), featureDim_(featureDim), windowFrames_(windowFrames),
+          historyFrames_(historyFrames), features_((windowFrames + historyFrames) * featureDim) {
+        if (frameShift == 0 || frameShift > frameLength) {
+            throw std::invalid_argument("Feature frame shift " + std::to_string(frameShift) +
+                                        " must be in (0, frame length " + std::to_string(frameLength) + "]");
+        }
+        if (featureDim == 0) {
+            throw std::invalid_argument("Feature frames need at least one value");
+        }
+    }
+
+    /**
+     * @brief Appends `samples` and runs `frontEnd` once over every frame they complete.
+     *
+     * @return Number of new feature frames.
+     */
+    size_t push(std::span<const float> samples, const FrontEnd& frontEnd) {
+        pending_.insert(pending_.end(), samples.begin(), samples.end());
+        if (pending_.size() < frameLength_) {
+            return 0;
+        }
+        const size_t frames = (pending_.size() - frameLength_) / frameShift_ + 1;
+        const size_t used   = (frames - 1) * frameShift_ + frameLength_;
+        scratch_.resize(frames * featureDim_);
+        frontEnd(std::span<const float>{pending_.data(), used}, frames, scratch_);
+        features_.append(scratch_);
+        // Keep the samples the next frame still overlaps with
+        const size_t consumed = std::min(frames * frameShift_, pending_.size());
+        pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(consumed));
+        computedFrames_ += frames;
+        return frames;
+    }
+
+    /**
+     * @brief Writes the newest `windowFrames` frames into window `index` of a tensor created with
+     *        `WindowTensor(windowFrames * featureDim, batch, featureDim)`, zero-padding at the front.
+     *
+     * @param endFrames How many of the newest frames to leave out, for batches of overlapping windows; at most
+     *                  `historyFrames()`, older frames are no longer cached.
+     */
+    void load(WindowTensor& tensor, size_t index = 0, size_t endFrames = 0) const {
+        tensor.load(features_, index, endFrames * featureDim_);
+    }
+
+    size_t featureDim() const { return featureDim_; }
+
+    size_t windowFrames() const { return windowFrames_; }
+
+    size_t historyFrames() const { return historyFrames_; }
+
+    /// Frames currently cached, at most `windowFrames() + historyFrames()`.
+    size_t frames() const { return features_.size() / featureDim_; }
+
+    /// Frames computed by the front end since construction or `reset`; the cost actually paid.
+    std::uint64_t computedFrames() const { return computedFrames_; }
+
+    void reset() {
+        pending_.clear();
+        features_.clear();
+        computedFrames_ = 0;
+    }
+
+  private:
+    const size_t frameLength_;
+    const size_t frameShift_;
+    const size_t featureDim_;
+    const size_t windowFrames_;
+    const size_t historyFrames_;
+    utils::RingBuffer<float> features_;
+    std::vector<float> pending_; // samples not yet consumed by a complete frame shift
+    std::vector<float> scratch_;
+    std::uint64_t computedFrames_ = 0;
+};
+
+} // namespace edf::voice
@@ -0,0 +1,72 @@
+/**
+ * @file hop_scheduler.h
+ * @brief Decides when the sliding voice window is due for a new score in streaming mode.
+ *
+ * In streaming mode capture delivers short chunks (100-250 ms) and the model scores the window ending at the newest
+ * sample once every hop. The window lives in the engine's ring buffer, so consecutive overlapping windows share their
+ * samples and only the newest hop is appended; this class only counts samples towards the next hop.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+namespace edf::voice {
+
+/**
+ * @class HopScheduler
+ * @brief Counts appended samples and reports how many hops have elapsed since the last score.
+ */
+class HopScheduler {
+  public:
+    HopScheduler() = default;
+
+    /// A `hop` of zero scores after every chunk, as before streaming mode.
+    HopScheduler(std::chrono::milliseconds hop, unsigned long sampleRate)
+        : hopSamples_(static_cast<size_t>(hop.count()) * sampleRate / 1000) {}
+
+    size_t hopSamples() const { return hopSamples_; }
+
+    /**
+     * @brief Accounts for `samples` new samples.
+     *
+     * @return How many hops became due, 0 when the window should not be scored yet. More than one means the caller
+     *         fell behind; it can score the latest window only, or one window per hop in a batch.
+     */
+    size_t advance(size_t samples) {
+        if (hopSamples_ == 0) {
+            return samples == 0 ? 0 : 1;
+        }
+        pending_ += samples;
+        const size_t due = pending_ / hopSamples_;
+        pending_ %= hopSamples_;
+        return due;
+    }
+
+    /// Samples appended since the last due hop.
+    size_t pending() const { return pending_; }
+
+    void reset() { pending_ = 0; }
+
+  private:
+    size_t hopSamples_ = 0;
+    size_t pending_    = 0;
+};
+
+/**
+ * @brief Samples the sliding buffer must hold so that every window of a batch is read from buffered audio.
+ *
+ * The windows of a batch end one hop (or, when every chunk is scored, one chunk) apart, so the oldest of `maxBatch`
+ * windows ends `(maxBatch - 1)` steps before the newest sample.
+ *
+ * @param windowLength Samples in one model window.
+ * @param maxBatch Most windows scored by one inference.
+ * @param step Largest distance between the ends of consecutive windows: the hop, or the longest chunk.
+ */
+inline size_t batchHistoryLength(size_t windowLength, size_t maxBatch, size_t step) {
+    return windowLength + (std::max<size_t>(maxBatch, 1) - 1) * step;
+}
+
+} // namespace edf::voice
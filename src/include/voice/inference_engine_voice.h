@@ -1,14 +1,27 @@
 #pragma once
 
-#include "utils/bounded_deque.h"
+#include "detection_lib_version.h"
+#include "utils/ring_buffer.h"
 #include "voice/audio_buffer.h"
+#include "voice/audio_normalizer.h"
+#include "voice/feature_cache.h"
+#include "voice/hop_scheduler.h"
+#include "voice/onnx_voice_session.h"
+#include "voice/score_window.h"
+#include "voice/tf_session_config.h"
+#include "voice/voice_activity.h"
+#include "voice/window_tensor.h"
 
 #include "tensorflow/c/c_api.h"
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 #include <variant>
 #include <optional>
+#include <span>
 
 namespace edf::voice {
 class InferenceEngineVoice {
@@ -18,16 +31,66 @@ class InferenceEngineVoice {
     TF_SessionOptions* sessionOpts_;
     TF_Session* session_;
 
-    utils::BoundedDeque<float> internalBuffer_;
-    utils::BoundedDeque<float> scores_;
+    // One window plus the history the largest batch reaches back into; see sizeInternalBuffer
+    utils::RingBuffer<float> internalBuffer_;
+    // Recent scores with their fake count, EMA and min/max kept up to date, so verdicts never rescan the window
+    ScoreWindow scores_;
 
-    std::vector<float> makeWindow(const AudioBuffer& incoming);
+    // Set when the model identifier runs on ONNX Runtime; the TF members above stay null then
+    std::optional<OnnxVoiceSession> onnxSession_;
+    VoiceBackend backend_ = VoiceBackend::TensorFlow;
+
+    // Converts captured chunks to mono float at the model rate before they enter internalBuffer_
+    std::optional<AudioNormalizer> normalizer_;
+
+    // Windows without speech skip inference and are reported as Analyzing; unset when gating is disabled. Fed only the
+    // new samples of each chunk (push), and asked for a decision when a window is due (windowIsSpeech)
+    std::optional<VoiceActivityDetector> voiceActivity_;
+
+    // loadAudioBuffer only scores once a hop of new samples has arrived; the overlap stays in internalBuffer_
+    HopScheduler hop_;
+
+    // Longest chunk loadAudioBuffers is fed, in model-rate samples (the maxChunk passed to loadTFModel/loadOnnxModel)
+    size_t maxChunkSamples_ = 0;
+
+    // Resizes (and empties) internalBuffer_ to batchHistoryLength(windowLength, maxBatchWindows, step), step being
+    // the larger of the hop and maxChunkSamples_, so older windows of a batch are never zero-padded. loadTFModel and
+    // loadOnnxModel call it once the window and batch depth are known, setHop again when the hop changes.
+    void sizeInternalBuffer(size_t windowLength, size_t maxBatchWindows) {
+        internalBuffer_.reset(
+            batchHistoryLength(windowLength, maxBatchWindows, std::max(hop_.hopSamples(), maxChunkSamples_)));
+    }
+
+    // Set when the graph is split at a front end: features are computed once per hop and cached, and only the
+    // classifier subgraph runs on each window
+    std::optional<FeatureCache> featureCache_;
+    FrontEndSplit frontEndSplit_;
+
+    // Runs the front-end subgraph over the samples of newly completed frames
+    void computeFeatures(std::span<const float> samples, size_t frames, std::span<float> features);
+
+    // Model input, created in loadTFModel; TF reads the window straight from its aligned buffer
+    std::unique_ptr<WindowTensor> windowTensor_;
+
+    // One [B, T] tensor per batch size, for catching up on queued chunks in a single TF_SessionRun; [B, frames,
+    // featureDim] when featureCache_ is set
+    std::unique_ptr<WindowBatches> windowBatches_;
+
+    // Runs `count` inferences on a silent window and clears it again
+    void warmUp(int count);
+
+    // Appends the incoming samples to internalBuffer_ and writes the current window into windowTensor_
+    void makeWindow(const AudioBuffer& incoming);
 
   public:
     InferenceEngineVoice();
     ~InferenceEngineVoice();
 
-    float runInference(std::vector<float>&, bool);
+    // Runs the model on the window last written by makeWindow
+    float runInference(bool useWinReverser);
+
+    // Runs the model once on the batch last loaded into windowBatches_; one score per window, in batch order
+    std::vector<float> runBatchInference(WindowTensor& batch, bool useWinReverser);
 
     struct DeepFake {
         std::vector<float> samples;
@@ -43,7 +106,52 @@ class InferenceEngineVoice {
     std::optional<Inference>
     loadAudioBuffer(const AudioBuffer& samples, bool noMoreIncoming, float threshold, bool useWinReverser);
 
-    void loadTFModel(const std::string& dirPath, const std::string& savedModelDirName);
+    // Batched counterpart of loadAudioBuffer for a backlog of chunks: scores the window ending at each chunk with one
+    // inference (in groups of at most maxBatchWindows) and returns one result per chunk, in order
+    std::vector<std::optional<Inference>> loadAudioBuffers(std::span<const AudioBuffer> chunks,
+                                                           bool noMoreIncoming,
+                                                           float threshold,
+                                                           bool useWinReverser);
+
+    // sessionConfig threading is applied to sessionOpts_ before the session is created; its warm-up inferences run on
+    // silence before returning, so the first real window does not pay graph initialisation. maxChunk is the longest
+    // chunk loadAudioBuffers will batch (voiceCaptureChunkMs); with maxBatchWindows it sizes internalBuffer_.
+    void loadTFModel(const std::string& dirPath,
+                     const std::string& savedModelDirName,
+                     unsigned long modelSampleRate,
+                     size_t maxBatchWindows               = 1,
+                     const TFSessionConfig& sessionConfig = {},
+                     std::chrono::milliseconds maxChunk   = std::chrono::milliseconds(0));
+    // ONNX Runtime counterpart of loadTFModel, loading onnxVoiceModelPath(dirPath, modelIdentifier) on the Ort::Env
+    // shared with video. runInference/runBatchInference dispatch on the loaded backend.
+    void loadOnnxModel(const std::string& dirPath,
+                       const std::string& modelIdentifier,
+                       unsigned long modelSampleRate,
+                       size_t maxBatchWindows             = 1,
+                       int intraOpThreads                 = 0,
+                       std::chrono::milliseconds maxChunk = std::chrono::milliseconds(0));
+    VoiceBackend backend() const { return backend_; }
+
+    // Runs the front end incrementally when every operation of `split` exists in the loaded graph and its framing is
+    // valid (see FeatureCache); returns false (keeping full-graph inference on raw windows) otherwise. Like
+    // internalBuffer_ on the raw path, the cache keeps the frames of maxBatchWindows hops (or maxChunk chunks)
+    // behind the newest window, and the classifier batches are [B, frames, featureDim] WindowBatches. Call after
+    // loadTFModel and setHop.
+    bool enableFeatureCache(const FrontEndSplit& split);
+
+    // Streaming mode: score the sliding window every `hop` of model-rate audio instead of after every chunk. Zero
+    // (the default) scores every chunk. Call after the model is loaded; resizes and empties internalBuffer_.
+    void setHop(std::chrono::milliseconds hop);
+
+    // Enables (or with std::nullopt disables) voice activity gating; call after loadTFModel
+    void setVoiceActivityGating(std::optional<VoiceActivityConfig> config);
+
+    // Scores of the current window with their running statistics
+    const ScoreWindow& scores() const { return scores_; }
+
+    // Fraction of windows that skipped inference since the buffers were last emptied
+    float gatedFraction() const { return voiceActivity_ ? voiceActivity_->gatedFraction() : 0.0f; }
+
     void emptyBuffers();
     void unloadTFModel();
 };
@@ -0,0 +1,233 @@
+/**
+ * @file multi_stream.h
+ * @brief Independent voice analysis of several channels or capture streams.
+ *
+ * Downmixing a call to one signal dilutes a fake speaker who is panned to one side or mixed under other sources. In
+ * per-stream mode every channel of the capture, or every mic/loopback stream, keeps its own normaliser, window, voice
+ * gate and score window. Per chunk, the worker pool prepares all streams concurrently. The windows that are due are
+ * then gathered into one `[streams, T]` batch and scored with a single run of the shared model session, and verdicts
+ * are reported per stream.
+ */
+
+#pragma once
+
+#include "utils/ring_buffer.h"
+#include "utils/worker_pool.h"
+#include "voice/audio_buffer.h"
+#include "voice/audio_normalizer.h"
+#include "voice/hop_scheduler.h"
+#include "voice/score_window.h"
+#include "voice/voice_activity.h"
+#include "voice/window_tensor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace edf::voice {
+
+/**
+ * @brief Splits interleaved `in` into one single-channel buffer per channel, reusing the storage of `out`.
+ */
+inline void splitChannels(const AudioBuffer& in, std::vector<AudioBuffer>& out) {
+    const size_t channels = std::max<size_t>(in.channels, 1);
+    const size_t width    = static_cast<size_t>(in.bytes_per_sample);
+    const size_t frames   = in.num_samples();
+    out.resize(channels);
+    for (size_t c = 0; c < channels; ++c) {
+        auto& channel            = out[c];
+        channel.rate             = in.rate;
+        channel.channels         = 1;
+        channel.bytes_per_sample = in.bytes_per_sample;
+        channel.is_float         = in.is_float;
+        channel.samples.resize(frames * width);
+        const auto* src = in.samples.data() + c * width;
+        auto* dst       = channel.samples.data();
+        for (size_t f = 0; f < frames; ++f) {
+            std::memcpy(dst + f * width, src + f * channels * width, width);
+        }
+    }
+}
+
+/**
+ * @brief Settings shared by every stream.
+ */
+struct VoiceStreamConfig {
+    unsigned long modelSampleRate = 16000;
+    size_t windowLength           = 0; ///< Model input samples
+    size_t scoreWindow            = 0; ///< Scores kept for the fake proportion
+    float threshold               = 0.5f;
+    std::chrono::milliseconds hop{0}; ///< See HopScheduler; 0 scores after every chunk
+    std::optional<VoiceActivityConfig> voiceActivity;
+};
+
+/**
+ * @brief Result of one chunk for one stream.
+ */
+struct VoiceStreamUpdate {
+    size_t stream = 0;
+    std::optional<float> score; ///< Unset when no window was due or the window had no speech
+    bool gated           = false;
+    float fakeProportion = 0.0f;
+};
+
+/**
+ * @class VoiceStream
+ * @brief Window and score state of one analysed stream.
+ */
+class VoiceStream {
+  public:
+    explicit VoiceStream(const VoiceStreamConfig& config)
+        : normalizer_(config.modelSampleRate), samples_(config.windowLength),
+          scores_(config.scoreWindow, config.threshold), hop_(config.hop, config.modelSampleRate) {
+        if (config.voiceActivity) {
+            voiceActivity_.emplace(config.modelSampleRate, *config.voiceActivity, config.windowLength);
+        }
+    }
+
+    /**
+     * @brief Appends a chunk of this stream.
+     *
+     * The voice gate only analyses the new samples; a due window is gated on the decisions kept for its frames.
+     *
+     * @return true when a window is due and has speech, i.e. should be scored.
+     */
+    bool push(const AudioBuffer& chunk) {
+        const auto mono = normalizer_.process(chunk);
+        samples_.append(mono);
+        if (voiceActivity_) {
+            voiceActivity_->push(mono);
+        }
+        gated_ = false;
+        if (hop_.advance(mono.size()) == 0) {
+            return false;
+        }
+        if (voiceActivity_) {
+            gated_ = !voiceActivity_->windowIsSpeech();
+        }
+        return !gated_;
+    }
+
+    /// Writes the current window into row `row` of a batch.
+    void loadWindow(WindowTensor& batch, size_t row) const { batch.load(samples_, row); }
+
+    void addScore(float score) { scores_.push(score); }
+
+    bool gated() const { return gated_; }
+
+    const ScoreWindow& scores() const { return scores_; }
+
+    void reset() {
+        normalizer_.reset();
+        samples_.clear();
+        scores_.clear();
+        hop_.reset();
+        if (voiceActivity_) {
+            voiceActivity_->reset();
+        }
+    }
+
+  private:
+    AudioNormalizer normalizer_;
+    utils::RingBuffer<float> samples_;
+    ScoreWindow scores_;
+    HopScheduler hop_;
+    std::optional<VoiceActivityDetector> voiceActivity_;
+    bool gated_ = false;
+};
+
+/**
+ * @class MultiStreamVoiceAnalyzer
+ * @brief Scores several streams against one shared model session.
+ */
+class MultiStreamVoiceAnalyzer {
+  public:
+    /// Runs the shared model session on every row of the batch, e.g. `InferenceEngineVoice::runBatchInference`.
+    using ScoreBatch = std::function<std::vector<float>(WindowTensor& batch)>;
+
+    /**
+     * @param streams Number of streams, e.g. capture channels.
+     * @param pool Prepares the streams of a chunk concurrently; must outlive the analyzer.
+     */
+    MultiStreamVoiceAnalyzer(size_t streams,
+                             const VoiceStreamConfig& config,
+                             ScoreBatch scoreBatch,
+                             utils::WorkerPool& pool)
+        : batches_(config.windowLength, streams), scoreBatch_(std::move(scoreBatch)), pool_(pool) {
+        streams_.reserve(streams);
+        for (size_t i = 0; i < streams; ++i) {
+            streams_.emplace_back(config);
+        }
+    }
+
+    size_t streams() const { return streams_.size(); }
+
+    const VoiceStream& stream(size_t index) const { return streams_[index]; }
+
+    /**
+     * @brief Analyses each channel of an interleaved capture chunk as its own stream.
+     */
+    std::vector<VoiceStreamUpdate> processChannels(const AudioBuffer& interleaved) {
+        splitChannels(interleaved, channels_);
+        return process(channels_);
+    }
+
+    /**
+     * @brief Analyses one chunk per stream, e.g. the mic and loopback captures of the same period.
+     *
+     * Streams beyond `chunks.size()` receive nothing this time.
+     */
+    std::vector<VoiceStreamUpdate> process(std::span<const AudioBuffer> chunks) {
+        const size_t count = std::min(chunks.size(), streams_.size());
+        due_.assign(count, 0);
+        pool_.parallelFor(count, [&](size_t i) { due_[i] = streams_[i].push(chunks[i]) ? 1 : 0; });
+
+        rows_.clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (due_[i]) {
+                rows_.push_back(i);
+            }
+        }
+        std::vector<float> scores;
+        if (!rows_.empty()) {
+            auto& batch = batches_.get(rows_.size());
+            pool_.parallelFor(rows_.size(), [&](size_t row) { streams_[rows_[row]].loadWindow(batch, row); });
+            scores = scoreBatch_(batch);
+        }
+
+        std::vector<VoiceStreamUpdate> updates(count);
+        for (size_t i = 0, row = 0; i < count; ++i) {
+            auto& update  = updates[i];
+            update.stream = i;
+            update.gated  = streams_[i].gated();
+            if (due_[i] && row < scores.size()) {
+                update.score = scores[row++];
+                streams_[i].addScore(*update.score);
+            }
+            update.fakeProportion = streams_[i].scores().fakeProportion();
+        }
+        return updates;
+    }
+
+    void reset() {
+        for (auto& stream : streams_) {
+            stream.reset();
+        }
+    }
+
+  private:
+    std::vector<VoiceStream> streams_;
+    WindowBatches batches_;
+    ScoreBatch scoreBatch_;
+    utils::WorkerPool& pool_;
+    std::vector<AudioBuffer> channels_;
+    std::vector<char> due_; // not vector<bool>: written concurrently by the pool
+    std::vector<size_t> rows_;
+};
+
+} // namespace edf::voice
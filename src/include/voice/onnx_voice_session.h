@@ -0,0 +1,133 @@
+/**
+ * @file onnx_voice_session.h
+ * @brief ONNX Runtime backend for the voice model.
+ *
+ * Runs an ONNX export of the voice model on the process wide `Ort::Env` also used by the video classifier, so a voice
+ * model selected for this backend does not need the TensorFlow runtime and its thread pool. The session reads the
+ * aligned window buffers of `WindowTensor` in place, batched or not.
+ */
+
+#pragma once
+
+#include "utils/logger.h"
+#include "vision/execution_providers.h"
+#include "voice/window_tensor.h"
+
+#include "onnxruntime_cxx_api.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace edf::voice {
+
+/**
+ * @brief Runtime a voice model identifier is run with.
+ */
+enum class VoiceBackend {
+    TensorFlow, ///< SavedModel directory through the TensorFlow C API
+    OnnxRuntime ///< `<identifier>.onnx.encrypted` on the shared ONNX Runtime environment
+};
+
+inline const char* toString(VoiceBackend backend) {
+    return backend == VoiceBackend::OnnxRuntime ? "onnxruntime" : "tensorflow";
+}
+
+/**
+ * @brief Parses a `voice*Backend` config value; anything but `"onnxruntime"`/`"onnx"` selects TensorFlow.
+ */
+inline VoiceBackend voiceBackendFromString(std::string_view name) {
+    return name == "onnxruntime" || name == "onnx" ? VoiceBackend::OnnxRuntime : VoiceBackend::TensorFlow;
+}
+
+/// File the encrypted ONNX export of `modelIdentifier` is expected in, next to the video models.
+inline std::filesystem::path onnxVoiceModelPath(const std::filesystem::path& dirPath,
+                                                const std::string& modelIdentifier) {
+    return dirPath / (modelIdentifier + ".onnx.encrypted");
+}
+
+/**
+ * @class OnnxVoiceSession
+ * @brief Voice model session scoring `[B, T]` windows with ONNX Runtime.
+ */
+class OnnxVoiceSession {
+  public:
+    /**
+     * @param modelPath Encrypted ONNX export of the voice model (see `onnxVoiceModelPath`), one float input `[B, T]`
+     *                  and one score output. It is decrypted in memory with `vision::decryptModelFile`.
+     * @param intraOpThreads 0 keeps the ONNX Runtime default.
+     * @throws std::runtime_error if the model cannot be decrypted.
+     * @throws Ort::Exception if the model cannot be loaded.
+     */
+    explicit OnnxVoiceSession(const std::filesystem::path& modelPath, int intraOpThreads = 0)
+        : memoryInfo_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {
+        Ort::SessionOptions options;
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        if (intraOpThreads > 0) {
+            options.SetIntraOpNumThreads(intraOpThreads);
+        }
+        const auto model = vision::decryptModelFile(modelPath);
+        session_         = Ort::Session(vision::sharedOrtEnv(), model.data(), model.size(), options);
+
+        Ort::AllocatorWithDefaultOptions allocator;
+        inputName_  = session_.GetInputNameAllocated(0, allocator).get();
+        outputName_ = session_.GetOutputNameAllocated(0, allocator).get();
+        LOG_INFO("Voice model {} loaded with ONNX Runtime", modelPath.filename().string());
+    }
+
+    /**
+     * @brief Scores every window of `input`.
+     *
+     * @return One score per window in batch order. When the model emits several values per window (class
+     *         probabilities), the last one is taken, matching the TensorFlow backend.
+     */
+    std::vector<float> run(WindowTensor& input) {
+        const std::int64_t shape[] = {static_cast<std::int64_t>(input.batch()),
+                                      static_cast<std::int64_t>(input.windowLength())};
+        auto tensor = Ort::Value::CreateTensor<float>(
+            memoryInfo_, input.window(0).data(), input.batch() * input.windowLength(), shape, 2);
+
+        const char* inputNames[]  = {inputName_.c_str()};
+        const char* outputNames[] = {outputName_.c_str()};
+        auto outputs = session_.Run(Ort::RunOptions{nullptr}, inputNames, &tensor, 1, outputNames, 1);
+
+        const auto count   = outputs[0].GetTensorTypeAndShapeInfo().GetElementCount();
+        const auto* values = outputs[0].GetTensorData<float>();
+        const size_t width = std::max<size_t>(count / std::max<size_t>(input.batch(), 1), 1);
+        std::vector<float> scores(input.batch());
+        for (size_t i = 0; i < scores.size(); ++i) {
+            scores[i] = values[i * width + width - 1];
+        }
+        return scores;
+    }
+
+  private:
+    Ort::MemoryInfo memoryInfo_;
+    Ort::Session session_{nullptr};
+    std::string inputName_;
+    std::string outputName_;
+};
+
+/**
+ * @brief Largest absolute difference between the scores of two backends on the same windows.
+ *
+ * Used together with `vision::verdictsAgree` when validating an ONNX export against the TensorFlow model on recorded
+ * audio.
+ */
+inline float maxScoreDifference(const std::vector<float>& reference, const std::vector<float>& candidate) {
+    if (reference.size() != candidate.size()) {
+        return std::numeric_limits<float>::infinity();
+    }
+    float worst = 0.0f;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        worst = std::max(worst, std::abs(reference[i] - candidate[i]));
+    }
+    return worst;
+}
+
+} // namespace edf::voice
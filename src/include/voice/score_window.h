@@ -0,0 +1,139 @@
+/**
+ * @file score_window.h
+ * @brief Constant-time statistics over the sliding window of voice model scores.
+ *
+ * The fake-proportion verdict (`voice*FakeProportionThreshold`) used to rescan every score in the window on each
+ * update. The window now keeps its aggregates up to date as scores enter and leave: the count above the probability
+ * threshold and the sum are adjusted by the two scores involved, and min/max come from monotonic deques whose fronts
+ * are the extremes. Each new score costs amortised O(1) regardless of the window length, so session-long windows of
+ * several minutes are as cheap as short ones.
+ */
+
+#pragma once
+
+#include "utils/ring_buffer.h"
+
+#include <cstdint>
+#include <limits>
+
+namespace edf::voice {
+
+/**
+ * @class ScoreWindow
+ * @brief Last `size` scores with their count above threshold, mean, EMA, min and max.
+ */
+class ScoreWindow {
+  public:
+    /**
+     * @param size Scores kept in the window.
+     * @param threshold Scores strictly above it count as fake.
+     * @param emaAlpha Weight of the newest score in the exponential moving average.
+     */
+    explicit ScoreWindow(size_t size, float threshold = 0.5f, float emaAlpha = 0.1f)
+        : scores_(size), minima_(size), maxima_(size), threshold_(threshold), emaAlpha_(emaAlpha) {}
+
+    void push(float score) {
+        if (scores_.maxSize() == 0) {
+            return;
+        }
+        if (scores_.full()) {
+            const float oldest = scores_.front();
+            sum_ -= oldest;
+            above_ -= oldest > threshold_ ? 1 : 0;
+            expire(minima_, next_ - scores_.size());
+            expire(maxima_, next_ - scores_.size());
+        }
+        scores_.append(score);
+        sum_ += score;
+        above_ += score > threshold_ ? 1 : 0;
+        ema_ = scores_.size() == 1 ? score : ema_ + emaAlpha_ * (score - ema_);
+
+        // Entries the new score dominates can never become the extreme again
+        while (!minima_.empty() && minima_.back().value >= score) {
+            minima_.drop_back(1);
+        }
+        minima_.append({next_, score});
+        while (!maxima_.empty() && maxima_.back().value <= score) {
+            maxima_.drop_back(1);
+        }
+        maxima_.append({next_, score});
+        ++next_;
+    }
+
+    /**
+     * @brief Changes the fake threshold; recounts the window once.
+     */
+    void setThreshold(float threshold) {
+        if (threshold == threshold_) {
+            return;
+        }
+        threshold_ = threshold;
+        above_     = 0;
+        for (size_t i = 0; i < scores_.size(); ++i) {
+            above_ += scores_[i] > threshold_ ? 1 : 0;
+        }
+    }
+
+    float threshold() const { return threshold_; }
+
+    size_t size() const { return scores_.size(); }
+
+    size_t maxSize() const { return scores_.maxSize(); }
+
+    bool full() const { return scores_.full(); }
+
+    bool empty() const { return scores_.empty(); }
+
+    /// Scores above the threshold in the window.
+    size_t countAbove() const { return above_; }
+
+    /// Fraction of the window above the threshold, compared against `voice*FakeProportionThreshold`.
+    float fakeProportion() const { return empty() ? 0.0f : static_cast<float>(above_) / scores_.size(); }
+
+    float mean() const { return empty() ? 0.0f : static_cast<float>(sum_ / scores_.size()); }
+
+    float ema() const { return ema_; }
+
+    float min() const { return empty() ? std::numeric_limits<float>::quiet_NaN() : minima_.front().value; }
+
+    float max() const { return empty() ? std::numeric_limits<float>::quiet_NaN() : maxima_.front().value; }
+
+    float newest() const { return scores_.back(); }
+
+    /// The underlying scores, oldest first.
+    const utils::RingBuffer<float>& scores() const { return scores_; }
+
+    void clear() {
+        scores_.clear();
+        minima_.clear();
+        maxima_.clear();
+        sum_   = 0.0;
+        above_ = 0;
+        ema_   = 0.0f;
+    }
+
+  private:
+    struct Entry {
+        std::uint64_t index;
+        float value;
+    };
+
+    // Drops the front of a monotonic deque if it is the score at `index` leaving the window
+    static void expire(utils::RingBuffer<Entry>& deque, std::uint64_t index) {
+        if (!deque.empty() && deque.front().index == index) {
+            deque.drop_front(1);
+        }
+    }
+
+    utils::RingBuffer<float> scores_;
+    utils::RingBuffer<Entry> minima_; // increasing values, front is the window minimum
+    utils::RingBuffer<Entry> maxima_; // decreasing values, front is the window maximum
+    float threshold_;
+    const float emaAlpha_;
+    double sum_         = 0.0; // double so minutes of additions and removals do not drift
+    size_t above_       = 0;
+    float ema_          = 0.0f;
+    std::uint64_t next_ = 0; // index of the next score pushed
+};
+
+} // namespace edf::voice
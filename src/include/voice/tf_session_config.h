@@ -0,0 +1,76 @@
+/**
+ * @file tf_session_config.h
+ * @brief Threading and warm-up settings of the TensorFlow voice session.
+ *
+ * The TensorFlow C API only accepts session settings as a serialized `tensorflow.ConfigProto`. The few fields needed
+ * here are plain varints, so the message is encoded by hand instead of linking protobuf.
+ */
+
+#pragma once
+
+#include "tensorflow/c/c_api.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace edf::voice {
+
+/**
+ * @brief TensorFlow session settings read from the `[voice]` config.
+ */
+struct TFSessionConfig {
+    int intraOpThreads   = 0; ///< Threads inside one op; 0 lets TensorFlow use every core
+    int interOpThreads   = 0; ///< Ops run concurrently; 0 lets TensorFlow use every core
+    int warmupInferences = 0; ///< Inferences on silence run in `loadTFModel` before the first real window
+};
+
+namespace detail {
+
+inline void appendVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline void appendVarintField(std::vector<std::uint8_t>& out, std::uint32_t field, std::uint64_t value) {
+    appendVarint(out, static_cast<std::uint64_t>(field) << 3); // wire type 0
+    appendVarint(out, value);
+}
+
+} // namespace detail
+
+/**
+ * @brief Serializes the threading part of `config` as a `tensorflow.ConfigProto`.
+ *
+ * Zero counts are left out so TensorFlow keeps its default for them; an empty result means nothing to set.
+ */
+inline std::vector<std::uint8_t> serializeConfigProto(const TFSessionConfig& config) {
+    constexpr std::uint32_t intraOpParallelismThreads = 2;
+    constexpr std::uint32_t interOpParallelismThreads = 5;
+    std::vector<std::uint8_t> proto;
+    if (config.intraOpThreads > 0) {
+        detail::appendVarintField(proto, intraOpParallelismThreads, static_cast<std::uint64_t>(config.intraOpThreads));
+    }
+    if (config.interOpThreads > 0) {
+        detail::appendVarintField(proto, interOpParallelismThreads, static_cast<std::uint64_t>(config.interOpThreads));
+    }
+    return proto;
+}
+
+/**
+ * @brief Applies `config` to session options before the session is created.
+ *
+ * @return false with `status` set if TensorFlow rejected the message.
+ */
+inline bool applySessionConfig(TF_SessionOptions* options, const TFSessionConfig& config, TF_Status* status) {
+    const auto proto = serializeConfigProto(config);
+    if (proto.empty()) {
+        return true;
+    }
+    TF_SetConfig(options, proto.data(), proto.size(), status);
+    return TF_GetCode(status) == TF_OK;
+}
+
+} // namespace edf::voice
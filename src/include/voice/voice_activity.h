@@ -0,0 +1,202 @@
+/**
+ * @file voice_activity.h
+ * @brief Cheap voice activity detection in front of the voice model.
+ *
+ * Long stretches of a call carry no speech. Each window is split into short frames, and a frame counts as speech when
+ * it is loud enough relative to a slowly tracked noise floor and is not spectrally flat (noise-like). Spectral
+ * flatness is estimated from a small real DFT over a fixed set of bins in the speech band, so the cost per window is
+ * a fraction of a model inference. Windows with too few speech frames skip inference. Silence and background noise
+ * are gated reliably; harmonic music mostly passes and is left to the model. Gating is opt-in (`voiceActivityGating`
+ * in `[voice]`) because windows it skips get no score, which changes the verdicts of existing sessions.
+ *
+ * Streaming callers push only the audio appended since the last hop. Each frame is then classified, and adapts the
+ * noise floor, exactly once, and the gate decision for a window comes from the decisions kept for its frames.
+ */
+
+#pragma once
+
+#include "utils/ring_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace edf::voice {
+
+/**
+ * @brief Tuning of the voice activity gate.
+ */
+struct VoiceActivityConfig {
+    float frameSecs           = 0.02f;  ///< Analysis frame length
+    float energyMarginDb      = 9.0f;   ///< Speech must be this far above the tracked noise floor
+    float absoluteFloorDb     = -60.0f; ///< Frames quieter than this (dBFS) are always silence
+    float maxFlatness         = 0.3f;   ///< Frames flatter than this are noise-like
+    float minSpeechFraction   = 0.1f;   ///< Fraction of speech frames needed to run inference on a window
+    float noiseFloorAdaptUp   = 0.002f; ///< Per-frame rate the noise floor rises towards louder frames
+    float noiseFloorAdaptDown = 0.3f;   ///< Per-frame rate the noise floor falls towards quieter frames
+};
+
+/**
+ * @class VoiceActivityDetector
+ * @brief Energy plus spectral-flatness gate over mono float windows.
+ */
+class VoiceActivityDetector {
+  public:
+    /**
+     * @param windowLength Samples in one model window; the frame decisions of that many samples are kept for
+     *                     `windowIsSpeech`.
+     */
+    explicit VoiceActivityDetector(unsigned long sampleRate, VoiceActivityConfig config = {}, size_t windowLength = 0)
+        : config_(config), frameLength_(std::max<size_t>(16, static_cast<size_t>(config.frameSecs * sampleRate))),
+          history_(std::max<size_t>(windowLength / frameLength_, 1)) {
+        // 16 bins spread over 150 Hz - 4 kHz cover voiced speech while staying cheap to evaluate
+        constexpr size_t bins = 16;
+        const double pi       = 3.14159265358979323846;
+        cosTable_.resize(bins * frameLength_);
+        sinTable_.resize(bins * frameLength_);
+        for (size_t b = 0; b < bins; ++b) {
+            const double hz    = 150.0 * std::pow(4000.0 / 150.0, static_cast<double>(b) / (bins - 1));
+            const double omega = 2.0 * pi * std::min(hz, sampleRate / 2.0) / sampleRate;
+            for (size_t n = 0; n < frameLength_; ++n) {
+                // Hann window folded into the basis
+                const double w                  = 0.5 - 0.5 * std::cos(2.0 * pi * n / (frameLength_ - 1));
+                cosTable_[b * frameLength_ + n] = static_cast<float>(w * std::cos(omega * n));
+                sinTable_[b * frameLength_ + n] = static_cast<float>(w * std::sin(omega * n));
+            }
+        }
+        power_.resize(bins);
+    }
+
+    /**
+     * @brief Decides whether a standalone window contains enough speech to be worth an inference.
+     *
+     * Updates the noise floor and the gating statistics. Overlapping windows would analyse, and adapt the noise floor
+     * on, the same frames again; stream them through `push` and `windowIsSpeech` instead.
+     */
+    bool isSpeech(std::span<const float> window) {
+        const size_t frames = window.size() / frameLength_;
+        size_t speechFrames = 0;
+        for (size_t f = 0; f < frames; ++f) {
+            if (isSpeechFrame(window.subspan(f * frameLength_, frameLength_))) {
+                ++speechFrames;
+            }
+        }
+        const bool speech = frames != 0 && speechFrames >= config_.minSpeechFraction * frames;
+        ++windows_;
+        if (!speech) {
+            ++gatedWindows_;
+        }
+        return speech;
+    }
+
+    /**
+     * @brief Classifies the frames completed by `samples`, the audio appended to the window since the last call.
+     *
+     * Samples of an incomplete frame wait for the next call. Decisions older than the window are forgotten.
+     */
+    void push(std::span<const float> samples) {
+        pending_.insert(pending_.end(), samples.begin(), samples.end());
+        size_t offset = 0;
+        for (; pending_.size() - offset >= frameLength_; offset += frameLength_) {
+            const bool speech = isSpeechFrame(std::span<const float>{pending_.data() + offset, frameLength_});
+            if (history_.full()) {
+                speechFrames_ -= history_.front();
+            }
+            history_.append(speech ? 1 : 0);
+            speechFrames_ += speech ? 1 : 0;
+        }
+        pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+
+    /**
+     * @brief Decides from the kept frame decisions whether the current window is worth an inference.
+     *
+     * Updates the gating statistics; the noise floor only moves in `push`.
+     */
+    bool windowIsSpeech() {
+        const size_t frames = history_.size();
+        const bool speech   = frames != 0 && speechFrames_ >= config_.minSpeechFraction * frames;
+        ++windows_;
+        if (!speech) {
+            ++gatedWindows_;
+        }
+        return speech;
+    }
+
+    /// Windows evaluated since the last `resetStatistics`.
+    std::uint64_t windows() const { return windows_; }
+
+    /// Windows that skipped inference since the last `resetStatistics`.
+    std::uint64_t gatedWindows() const { return gatedWindows_; }
+
+    /// Fraction of windows that skipped inference.
+    float gatedFraction() const { return windows_ == 0 ? 0.0f : static_cast<float>(gatedWindows_) / windows_; }
+
+    void resetStatistics() {
+        windows_      = 0;
+        gatedWindows_ = 0;
+    }
+
+    /// Forgets the noise floor and the frame decisions, e.g. at the start of a new session.
+    void reset() {
+        noiseFloorDb_ = config_.absoluteFloorDb;
+        history_.clear();
+        pending_.clear();
+        speechFrames_ = 0;
+        resetStatistics();
+    }
+
+  private:
+    bool isSpeechFrame(std::span<const float> frame) {
+        double energy = 0.0;
+        for (float s : frame) {
+            energy += static_cast<double>(s) * s;
+        }
+        const float db = 10.0f * std::log10(static_cast<float>(energy / frame.size()) + 1e-12f);
+
+        const float rate = db > noiseFloorDb_ ? config_.noiseFloorAdaptUp : config_.noiseFloorAdaptDown;
+        const bool loud  = db > config_.absoluteFloorDb && db > noiseFloorDb_ + config_.energyMarginDb;
+        noiseFloorDb_ += rate * (db - noiseFloorDb_);
+        if (!loud) {
+            return false;
+        }
+        return flatness(frame) < config_.maxFlatness;
+    }
+
+    // Geometric over arithmetic mean of the band powers: ~1 for white noise, small for harmonic speech
+    float flatness(std::span<const float> frame) {
+        const size_t bins = power_.size();
+        for (size_t b = 0; b < bins; ++b) {
+            const float* c = &cosTable_[b * frameLength_];
+            const float* s = &sinTable_[b * frameLength_];
+            float re = 0.0f, im = 0.0f;
+            for (size_t n = 0; n < frameLength_; ++n) {
+                re += frame[n] * c[n];
+                im += frame[n] * s[n];
+            }
+            power_[b] = re * re + im * im + 1e-12f;
+        }
+        double logSum = 0.0, sum = 0.0;
+        for (float p : power_) {
+            logSum += std::log(p);
+            sum += p;
+        }
+        return static_cast<float>(std::exp(logSum / bins) / (sum / bins));
+    }
+
+    const VoiceActivityConfig config_;
+    const size_t frameLength_;
+    std::vector<float> cosTable_;
+    std::vector<float> sinTable_;
+    std::vector<float> power_;
+    utils::RingBuffer<std::uint8_t> history_; // 1 per speech frame of the window, oldest first
+    size_t speechFrames_ = 0;                 // ones in history_
+    std::vector<float> pending_;              // samples of the incomplete newest frame
+    float noiseFloorDb_         = config_.absoluteFloorDb;
+    std::uint64_t windows_      = 0;
+    std::uint64_t gatedWindows_ = 0;
+};
+
+} // namespace edf::voice
@@ -0,0 +1,198 @@
+/**
+ * @file voice_benchmark.h
+ * @brief Real-time-factor benchmark of the voice path.
+ *
+ * Streams reference audio chunk by chunk through `InferenceEngineVoice::loadAudioBuffer` (normalisation, windowing,
+ * gating and inference) on the calling thread, as `runVoiceDetection` does. It records per-chunk latency, wall and
+ * thread CPU time, and the resident memory the run adds. The same audio is rendered at several capture rates and
+ * channel layouts, so the cost of each WASAPI mix format can be compared. Results serialise to JSON for tracking
+ * regressions across builds and machines; `x_phy_bench/voice_benchmark.cpp` is the command-line driver.
+ */
+
+#pragma once
+
+#include "utils/process_metrics.h"
+#include "utils/timer.h"
+#include "voice/audio_buffer.h"
+#include "voice/audio_source.h"
+#include "voice/inference_engine_voice.h"
+
+#include "json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace edf::voice {
+
+/**
+ * @class BufferSource
+ * @brief In-memory interleaved float32 audio, for benchmarks that should not measure disk I/O.
+ */
+class BufferSource : public AudioSource {
+  public:
+    BufferSource(std::vector<float> samples, unsigned long rate, size_t channels)
+        : samples_(std::move(samples)), rate_(rate), channels_(channels) {}
+
+    bool read(std::chrono::milliseconds duration, AudioBuffer& out) override {
+        const size_t frames = std::min(static_cast<size_t>(duration.count()) * rate_ / 1000,
+                                       (samples_.size() - position_) / channels_);
+        out.rate             = rate_;
+        out.channels         = channels_;
+        out.bytes_per_sample = sizeof(float);
+        out.is_float         = true;
+        out.samples.resize(frames * channels_ * sizeof(float));
+        std::memcpy(out.samples.data(), samples_.data() + position_, out.samples.size());
+        position_ += frames * channels_;
+        return frames != 0;
+    }
+
+    unsigned long rate() const override { return rate_; }
+
+    size_t channels() const override { return channels_; }
+
+    void rewind() { position_ = 0; }
+
+  private:
+    std::vector<float> samples_;
+    const unsigned long rate_;
+    const size_t channels_;
+    size_t position_ = 0;
+};
+
+/**
+ * @brief Renders mono reference audio at `rate` into `channels` interleaved channels.
+ *
+ * Linear interpolation is enough here: the benchmark measures cost, not accuracy.
+ */
+inline std::vector<float>
+renderReference(const std::vector<float>& mono, unsigned long monoRate, unsigned long rate, size_t channels) {
+    const size_t frames = monoRate == 0 ? 0 : mono.size() * rate / monoRate;
+    std::vector<float> out(frames * channels);
+    for (size_t i = 0; i < frames; ++i) {
+        const double position = static_cast<double>(i) * monoRate / rate;
+        const size_t index    = static_cast<size_t>(position);
+        const double fraction = position - index;
+        const float next      = index + 1 < mono.size() ? mono[index + 1] : mono[index];
+        const float value     = static_cast<float>(mono[index] + fraction * (next - mono[index]));
+        std::fill_n(out.begin() + i * channels, channels, value);
+    }
+    return out;
+}
+
+/**
+ * @brief Measurements of one benchmark run.
+ */
+struct VoiceBenchmarkResult {
+    unsigned long rate = 0;
+    size_t channels    = 0;
+    size_t chunks      = 0;
+    size_t inferences  = 0; ///< Chunks that produced a new score
+    double audioSecs   = 0.0;
+    double wallSecs    = 0.0;
+    double cpuSecs     = 0.0; ///< CPU time of the benchmark thread, excluding TF/ORT pool threads
+    double p50Ms       = 0.0;
+    double p90Ms       = 0.0;
+    double p99Ms       = 0.0;
+    double maxMs       = 0.0;
+
+    /// Growth of the process RSS over this run: buffers the run allocated, not the model loaded before it
+    size_t residentBytesAdded = 0;
+
+    /// Audio seconds processed per wall second; above 1 keeps up with live capture.
+    double realTimeFactor() const { return wallSecs == 0.0 ? 0.0 : audioSecs / wallSecs; }
+
+    nlohmann::json toJson() const {
+        return {{"rate", rate},
+                {"channels", channels},
+                {"chunks", chunks},
+                {"inferences", inferences},
+                {"audio_secs", audioSecs},
+                {"wall_secs", wallSecs},
+                {"cpu_secs", cpuSecs},
+                {"real_time_factor", realTimeFactor()},
+                {"latency_ms", {{"p50", p50Ms}, {"p90", p90Ms}, {"p99", p99Ms}, {"max", maxMs}}},
+                {"resident_bytes_added", residentBytesAdded}};
+    }
+};
+
+namespace detail {
+
+inline double percentile(std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const auto index = static_cast<size_t>(std::ceil(p * sorted.size())) - 1;
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+} // namespace detail
+
+/**
+ * @brief Streams `source` through `engine` as fast as it runs and measures it.
+ *
+ * The engine must have a model loaded; its buffers are emptied before and after the run.
+ */
+inline VoiceBenchmarkResult runVoiceBenchmark(InferenceEngineVoice& engine,
+                                              AudioSource& source,
+                                              std::chrono::milliseconds chunk,
+                                              float threshold,
+                                              bool useWinReverser = false) {
+    VoiceBenchmarkResult result;
+    result.rate     = source.rate();
+    result.channels = source.channels();
+
+    std::vector<double> latencies;
+    AudioBuffer buffer;
+    engine.emptyBuffers();
+    const auto residentBefore = utils::residentBytes();
+    const auto cpuStart       = utils::threadCpuTime();
+    const utils::Timer wall;
+    while (source.read(chunk, buffer)) {
+        const utils::Timer timer;
+        const auto inference = engine.loadAudioBuffer(buffer, false, threshold, useWinReverser);
+        latencies.push_back(std::chrono::duration<double, std::milli>(timer.elapsed()).count());
+        result.audioSecs += static_cast<double>(buffer.num_samples()) / std::max(source.rate(), 1ul);
+        result.inferences += inference.has_value() ? 1 : 0;
+    }
+    result.wallSecs = std::chrono::duration<double>(wall.elapsed()).count();
+    result.cpuSecs  = std::chrono::duration<double>(utils::threadCpuTime() - cpuStart).count();
+    // Read before emptyBuffers so the chunk and window buffers the run grew still count
+    const auto residentAfter  = utils::residentBytes();
+    result.residentBytesAdded = residentAfter > residentBefore ? residentAfter - residentBefore : 0;
+    engine.emptyBuffers();
+
+    result.chunks = latencies.size();
+    std::sort(latencies.begin(), latencies.end());
+    result.p50Ms = detail::percentile(latencies, 0.50);
+    result.p90Ms = detail::percentile(latencies, 0.90);
+    result.p99Ms = detail::percentile(latencies, 0.99);
+    result.maxMs = latencies.empty() ? 0.0 : latencies.back();
+    return result;
+}
+
+/**
+ * @brief Runs the benchmark on `mono` rendered at every rate and channel layout, returning a JSON array.
+ */
+inline nlohmann::json runVoiceBenchmarkMatrix(InferenceEngineVoice& engine,
+                                              const std::vector<float>& mono,
+                                              unsigned long monoRate,
+                                              const std::vector<unsigned long>& rates,
+                                              const std::vector<size_t>& layouts,
+                                              std::chrono::milliseconds chunk,
+                                              float threshold) {
+    auto results = nlohmann::json::array();
+    for (auto rate : rates) {
+        for (auto channels : layouts) {
+            BufferSource source{renderReference(mono, monoRate, rate, channels), rate, channels};
+            results.push_back(runVoiceBenchmark(engine, source, chunk, threshold).toJson());
+        }
+    }
+    return results;
+}
+
+} // namespace edf::voice
@@ -0,0 +1,154 @@
+/**
+ * @file window_tensor.h
+ * @brief TensorFlow input tensor wrapping a reused, aligned audio window buffer.
+ *
+ * The tensor is created once over a 64-byte aligned buffer with a no-op deallocator, so TensorFlow reads the
+ * samples in place instead of copying them. Each inference only rewrites the buffer from the sliding window.
+ */
+
+#pragma once
+
+#include "utils/ring_buffer.h"
+
+#include "tensorflow/c/c_api.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace edf::voice {
+class WindowTensor {
+  public:
+    /// Alignment TensorFlow needs to use a buffer without copying it (EIGEN_MAX_ALIGN_BYTES).
+    static constexpr size_t alignment = 64;
+
+    /**
+     * @brief Allocates a zeroed `[batch, windowLength]` float tensor, or `[batch, windowLength / featureDim,
+     *        featureDim]` for windows of feature frames (see FeatureCache).
+     *
+     * @throws std::bad_alloc
+     */
+    explicit WindowTensor(size_t windowLength, size_t batch = 1, size_t featureDim = 0)
+        : windowLength_(windowLength), batch_(batch) {
+        const size_t bytes = (windowLength * batch * sizeof(float) + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+        data_ = static_cast<float*>(_aligned_malloc(bytes, alignment));
+#else
+        data_ = static_cast<float*>(std::aligned_alloc(alignment, bytes));
+#endif
+        if (data_ == nullptr) {
+            throw std::bad_alloc{};
+        }
+        std::memset(data_, 0, bytes);
+        const std::int64_t frames = featureDim == 0 ? windowLength : windowLength / featureDim;
+        const std::int64_t dims[] = {static_cast<std::int64_t>(batch), frames, static_cast<std::int64_t>(featureDim)};
+        const int rank            = featureDim == 0 ? 2 : 3;
+        tensor_ =
+            TF_NewTensor(TF_FLOAT, dims, rank, data_, windowLength * batch * sizeof(float), &noDeallocate, nullptr);
+    }
+
+    WindowTensor(const WindowTensor&)            = delete;
+    WindowTensor& operator=(const WindowTensor&) = delete;
+
+    ~WindowTensor() {
+        TF_DeleteTensor(tensor_);
+#ifdef _WIN32
+        _aligned_free(data_);
+#else
+        std::free(data_);
+#endif
+    }
+
+    /// Tensor to pass to `TF_SessionRun`; it stays owned by this object.
+    TF_Tensor* tensor() const { return tensor_; }
+
+    size_t windowLength() const { return windowLength_; }
+
+    size_t batch() const { return batch_; }
+
+    /// Samples of window `index` of the batch.
+    std::span<float> window(size_t index = 0) { return {data_ + index * windowLength_, windowLength_}; }
+
+    /**
+     * @brief Writes `windowLength()` samples of `samples` into window `index`, zero-padding at the front when fewer
+     *        are available.
+     *
+     * @param samples Sliding sample buffer.
+     * @param index Window of the batch to write.
+     * @param endOffset How many of the newest samples to leave out; 0 takes the newest window. Batches of
+     *                  overlapping windows use increasing offsets over the same buffer.
+     */
+    void load(const utils::RingBuffer<float>& samples, size_t index = 0, size_t endOffset = 0) {
+        samples.copyWindow(window(index).data(), windowLength_, endOffset);
+    }
+
+  private:
+    static void noDeallocate(void*, size_t, void*) {}
+
+    const size_t windowLength_;
+    const size_t batch_;
+    float* data_       = nullptr;
+    TF_Tensor* tensor_ = nullptr;
+};
+/**
+ * @class WindowBatches
+ * @brief Lazily created `[B, windowLength]` tensors, or `[B, frames, featureDim]` ones for feature windows, for
+ *        every batch size up to a maximum.
+ *
+ * TensorFlow needs the exact batch dimension, so one tensor per batch size is kept and reused.
+ */
+class WindowBatches {
+  public:
+    WindowBatches(size_t windowLength, size_t maxBatch, size_t featureDim = 0)
+        : windowLength_(windowLength), featureDim_(featureDim), tensors_(maxBatch) {}
+
+    size_t maxBatch() const { return tensors_.size(); }
+
+    /// Tensor for `batch` windows, 1 <= batch <= maxBatch().
+    WindowTensor& get(size_t batch) {
+        auto& tensor = tensors_.at(batch - 1);
+        if (!tensor) {
+            tensor = std::make_unique<WindowTensor>(windowLength_, batch, featureDim_);
+        }
+        return *tensor;
+    }
+
+    /**
+     * @brief Loads the last `batch` windows ending every `hop` samples, oldest first, into one tensor.
+     *
+     * Window `i` ends `(batch - 1 - i) * hop` samples before the newest sample.
+     */
+    WindowTensor& load(const utils::RingBuffer<float>& samples, size_t batch, size_t hop) {
+        auto& tensor = get(batch);
+        for (size_t i = 0; i < batch; ++i) {
+            tensor.load(samples, i, (batch - 1 - i) * hop);
+        }
+        return tensor;
+    }
+
+    /**
+     * @brief Loads one window per entry of `endOffsets` (samples left out at the newest end), in that order.
+     */
+    WindowTensor& load(const utils::RingBuffer<float>& samples, std::span<const size_t> endOffsets) {
+        auto& tensor = get(endOffsets.size());
+        for (size_t i = 0; i < endOffsets.size(); ++i) {
+            tensor.load(samples, i, endOffsets[i]);
+        }
+        return tensor;
+    }
+
+  private:
+    const size_t windowLength_;
+    const size_t featureDim_;
+    std::vector<std::unique_ptr<WindowTensor>> tensors_;
+};
+} // namespace edf::voice
@@ -6,10 +6,13 @@
 #pragma once
 
 #include "utils/logger.h"
+#include "voice/audio_buffer_pool.h"
 #include "voice/audio_capture.h"
+#include "voice/capture_backpressure.h"
 
 #include "toml.hpp"
 
+#include <chrono>
 #include <format>
 #include <fstream>
 
@@ -21,16 +24,30 @@ namespace edf::windows {
  * @param run Atomic flag to control capture loop termination.
  * @param captureDurationSecs Duration of each capture window in seconds.
  * @param captureQueue The queue into which audio buffers are pushed.
+ * @param bufferPool Buffers released by inference, refilled instead of allocating new ones when given.
+ * @param backpressure Bounds the queue when inference falls behind; the queue grows unbounded when not given.
+ * @param captureChunk Length of each captured chunk, `ApplicationController::voiceCaptureChunk()`; zero captures
+ *                     whole `captureDurationSecs` windows.
  * @throws std::system_error
  */
 void voiceCapture(std::atomic_bool& run,
                   int captureDurationSecs,
-                  moodycamel::ReaderWriterQueue<voice::AudioBuffer>& captureQueue) {
+                  moodycamel::ReaderWriterQueue<voice::AudioBuffer>& captureQueue,
+                  voice::AudioBufferPool* bufferPool = nullptr,
+                  voice::CaptureBackpressure* backpressure = nullptr,
+                  std::chrono::milliseconds captureChunk = {}) {
     LOG_DEBUG("Start capturing audio");
     try {
         voice::AudioCapture audio{voice::AudioType::Stereo};
         while (run) {
-            bool succeeded = captureQueue.enqueue(audio.read(captureDurationSecs));
+            auto buffer = bufferPool ? bufferPool->acquire() : voice::AudioBuffer{};
+            if (captureChunk.count() > 0) {
+                audio.read(captureChunk, buffer);
+            } else {
+                audio.read(captureDurationSecs, buffer);
+            }
+            bool succeeded = backpressure ? backpressure->enqueue(captureQueue, std::move(buffer), run)
+                                          : captureQueue.enqueue(std::move(buffer));
             if (!succeeded) {
                 run = false;
                 break;
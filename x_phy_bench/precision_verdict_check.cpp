@@ -0,0 +1,145 @@
+// Reference crop check for reduced precision video classifiers: loads the fp32 classifier and its fp16/bf16 variant,
+// scores every face crop of a directory with both and prints, as JSON, the crops whose verdict differs at the
+// configured threshold and the largest score difference.
+//
+// Usage: precision_verdict_check --models DIR --model FILE --crops DIR [--precision fp16|bf16|auto]
+//                                [--threshold T] [--fake-index I]
+//
+// The exit status is non-zero when any verdict differs, or when the engine fell back to fp32 (no converted model, no
+// CPU support, or its own startup check failed), so there was nothing to compare.
+
+#include "utils/logger.h"
+#include "vision/inference_engine.h"
+#include "vision/precision.h"
+
+#include "json.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::filesystem::path models;
+    std::string model;
+    std::filesystem::path crops;
+    std::string precision = "auto";
+    float threshold       = 0.5f;
+    size_t fakeIndex      = 1;
+};
+
+int usage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " --models DIR --model FILE --crops DIR [--precision fp16|bf16|auto] [--threshold T]"
+                 " [--fake-index I]\n";
+    return EXIT_FAILURE;
+}
+
+// Both precisions see the same blob, so the comparison holds for any normalisation; this is the file scan's input
+cv::Mat classifierBlob(const cv::Mat& crop) {
+    const int side = edf::vision::InferenceEngine::onnx_inf_len;
+    return cv::dnn::blobFromImage(crop, 1.0 / 255.0, cv::Size(side, side), cv::Scalar(), true, false);
+}
+
+// Fake probability of one crop
+float score(edf::vision::InferenceEngine& engine, const cv::Mat& crop, size_t fakeIndex) {
+    auto blob    = classifierBlob(crop);
+    auto outputs = engine.runOnnxInference(blob);
+    return engine.outputAsFloat(outputs.front())[fakeIndex];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 == argc) {
+            return usage(argv[0]);
+        }
+        const std::string value = argv[++i];
+        if (arg == "--models") {
+            options.models = value;
+        } else if (arg == "--model") {
+            options.model = value;
+        } else if (arg == "--crops") {
+            options.crops = value;
+        } else if (arg == "--precision") {
+            options.precision = value;
+        } else if (arg == "--threshold") {
+            options.threshold = std::stof(value);
+        } else if (arg == "--fake-index") {
+            options.fakeIndex = std::stoul(value);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (options.models.empty() || options.model.empty() || options.crops.empty()) {
+        return usage(argv[0]);
+    }
+
+    std::error_code ec;
+    const auto logsDir = std::filesystem::temp_directory_path(ec) / "x-phy-bench";
+    std::filesystem::create_directories(logsDir, ec);
+    edf::Logger::intialise(logsDir);
+
+    try {
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(options.crops)) {
+            if (entry.is_regular_file()) {
+                files.push_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        edf::vision::InferenceEngine fp32;
+        fp32.setupOnnxRuntime(options.models.string(), options.model);
+        edf::vision::OnnxRuntimeOptions reducedOptions;
+        reducedOptions.precision = edf::vision::resolvePrecision(options.precision);
+        edf::vision::InferenceEngine reduced;
+        reduced.setupOnnxRuntime(options.models.string(), options.model, reducedOptions);
+
+        nlohmann::json report = {{"requested_precision", options.precision},
+                                 {"loaded_precision", edf::vision::toString(reduced.precision())},
+                                 {"threshold", options.threshold}};
+        if (reduced.precision() == edf::vision::Precision::FP32) {
+            std::cout << report.dump(2) << "\n";
+            return EXIT_FAILURE;
+        }
+
+        std::vector<float> reference;
+        std::vector<float> candidate;
+        auto disagreements = nlohmann::json::array();
+        float difference   = 0.0f;
+        for (const auto& file : files) {
+            const cv::Mat crop = cv::imread(file.string(), cv::IMREAD_COLOR);
+            if (crop.empty()) {
+                continue;
+            }
+            reference.push_back(score(fp32, crop, options.fakeIndex));
+            candidate.push_back(score(reduced, crop, options.fakeIndex));
+            difference = std::max(difference, std::abs(reference.back() - candidate.back()));
+            if ((reference.back() > options.threshold) != (candidate.back() > options.threshold)) {
+                disagreements.push_back(
+                    {{"crop", file.filename().string()}, {"fp32", reference.back()}, {"reduced", candidate.back()}});
+            }
+        }
+
+        const bool agree = edf::vision::verdictsAgree(reference, candidate, options.threshold);
+        report["crops"]                = reference.size();
+        report["max_score_difference"] = difference;
+        report["verdicts_agree"]       = agree;
+        report["disagreements"]        = std::move(disagreements);
+        std::cout << report.dump(2) << "\n";
+        return agree && !reference.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,168 @@
+// Equivalence harness for the voice backends: streams recorded audio through the TensorFlow SavedModel and its ONNX
+// export side by side and prints, as JSON, their score differences and verdict agreement, plus the load time and
+// resident memory each backend adds at startup.
+//
+// Usage: voice_backend_compare --models DIR --tf IDENTIFIER --onnx IDENTIFIER --audio FILE
+//                              [--rate HZ] [--chunk-ms MS] [--threshold T] [--tolerance D]
+//                              [--only tensorflow|onnxruntime]
+//
+// --only loads a single backend and skips the comparison, so its startup RSS is measured without the other runtime
+// already resident. The exit status is non-zero when verdicts disagree or a score differs by more than --tolerance.
+
+#include "utils/logger.h"
+#include "utils/process_metrics.h"
+#include "utils/timer.h"
+#include "vision/precision.h"
+#include "voice/audio_source.h"
+#include "voice/inference_engine_voice.h"
+#include "voice/onnx_voice_session.h"
+
+#include "json.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using edf::voice::InferenceEngineVoice;
+using edf::voice::VoiceBackend;
+
+struct Options {
+    std::filesystem::path models;
+    std::string tfIdentifier;
+    std::string onnxIdentifier;
+    std::filesystem::path audio;
+    unsigned long rate = 16000;
+    std::chrono::milliseconds chunk{250};
+    float threshold = 0.5f;
+    float tolerance = 1e-3f;
+    std::optional<VoiceBackend> only;
+};
+
+int usage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " --models DIR --tf IDENTIFIER --onnx IDENTIFIER --audio FILE [--rate HZ] [--chunk-ms MS]"
+                 " [--threshold T] [--tolerance D] [--only tensorflow|onnxruntime]\n";
+    return EXIT_FAILURE;
+}
+
+// Loads one backend and measures what it costs before the first real window
+nlohmann::json load(InferenceEngineVoice& engine, VoiceBackend backend, const Options& options) {
+    const auto residentBefore = edf::utils::residentBytes();
+    const edf::utils::Timer timer;
+    if (backend == VoiceBackend::OnnxRuntime) {
+        engine.loadOnnxModel(options.models.string(), options.onnxIdentifier, options.rate);
+    } else {
+        engine.loadTFModel(options.models.string(), options.tfIdentifier, options.rate);
+    }
+    const auto loadMs         = std::chrono::duration<double, std::milli>(timer.elapsed()).count();
+    const auto residentAfter  = edf::utils::residentBytes();
+    const auto residentGrowth = residentAfter > residentBefore ? residentAfter - residentBefore : 0;
+    return {{"backend", edf::voice::toString(backend)}, {"load_ms", loadMs}, {"resident_bytes_added", residentGrowth}};
+}
+
+// Score of the window the last loadAudioBuffer call scored, if it ran inference
+std::optional<float> scoreOf(const InferenceEngineVoice& engine,
+                             const std::optional<InferenceEngineVoice::Inference>& inference) {
+    if (!inference || !(std::holds_alternative<InferenceEngineVoice::Real>(*inference) ||
+                        std::holds_alternative<InferenceEngineVoice::DeepFake>(*inference))) {
+        return std::nullopt;
+    }
+    return engine.scores().newest();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 == argc) {
+            return usage(argv[0]);
+        }
+        const std::string value = argv[++i];
+        if (arg == "--models") {
+            options.models = value;
+        } else if (arg == "--tf") {
+            options.tfIdentifier = value;
+        } else if (arg == "--onnx") {
+            options.onnxIdentifier = value;
+        } else if (arg == "--audio") {
+            options.audio = value;
+        } else if (arg == "--rate") {
+            options.rate = std::stoul(value);
+        } else if (arg == "--chunk-ms") {
+            options.chunk = std::chrono::milliseconds(std::stoi(value));
+        } else if (arg == "--threshold") {
+            options.threshold = std::stof(value);
+        } else if (arg == "--tolerance") {
+            options.tolerance = std::stof(value);
+        } else if (arg == "--only") {
+            options.only = edf::voice::voiceBackendFromString(value);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (options.models.empty() || options.audio.empty() || options.tfIdentifier.empty() ||
+        options.onnxIdentifier.empty()) {
+        return usage(argv[0]);
+    }
+
+    std::error_code ec;
+    const auto logsDir = std::filesystem::temp_directory_path(ec) / "x-phy-bench";
+    std::filesystem::create_directories(logsDir, ec);
+    edf::Logger::intialise(logsDir);
+
+    try {
+        auto report = nlohmann::json::object();
+        if (options.only) {
+            InferenceEngineVoice engine;
+            report["startup"] = nlohmann::json::array({load(engine, *options.only, options)});
+            std::cout << report.dump(2) << "\n";
+            return EXIT_SUCCESS;
+        }
+
+        InferenceEngineVoice tensorflow;
+        InferenceEngineVoice onnx;
+        report["startup"] = nlohmann::json::array(
+            {load(tensorflow, VoiceBackend::TensorFlow, options), load(onnx, VoiceBackend::OnnxRuntime, options)});
+
+        // Both engines see the same chunks, so the windows they score line up one to one
+        edf::voice::SndFileSource source{options.audio};
+        edf::voice::AudioBuffer chunk;
+        std::vector<float> reference;
+        std::vector<float> candidate;
+        size_t unpaired = 0;
+        while (source.read(options.chunk, chunk)) {
+            const auto tfInference   = tensorflow.loadAudioBuffer(chunk, false, options.threshold, false);
+            const auto onnxInference = onnx.loadAudioBuffer(chunk, false, options.threshold, false);
+            const auto tfScore       = scoreOf(tensorflow, tfInference);
+            const auto onnxScore     = scoreOf(onnx, onnxInference);
+            if (tfScore && onnxScore) {
+                reference.push_back(*tfScore);
+                candidate.push_back(*onnxScore);
+            } else if (tfScore || onnxScore) {
+                ++unpaired;
+            }
+        }
+
+        const float difference = edf::voice::maxScoreDifference(reference, candidate);
+        const bool agree = unpaired == 0 && edf::vision::verdictsAgree(reference, candidate, options.threshold);
+        report["windows"]              = reference.size();
+        report["unpaired_windows"]     = unpaired;
+        report["max_score_difference"] = difference;
+        report["verdicts_agree"]       = agree;
+        std::cout << report.dump(2) << "\n";
+        return agree && difference <= options.tolerance ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,146 @@
+// Real-time-factor benchmark of the voice path: loads one voice model, renders recorded audio at each capture rate
+// and channel layout, streams it through InferenceEngineVoice and prints the runs as JSON (see voice_benchmark.h).
+//
+// Usage: voice_benchmark --models DIR --model IDENTIFIER --audio FILE [--backend tensorflow|onnxruntime]
+//                        [--model-rate HZ] [--rates HZ,HZ,...] [--layouts N,N,...] [--chunk-ms MS] [--threshold T]
+
+#include "utils/logger.h"
+#include "utils/process_metrics.h"
+#include "utils/timer.h"
+#include "voice/audio_normalizer.h"
+#include "voice/audio_source.h"
+#include "voice/inference_engine_voice.h"
+#include "voice/onnx_voice_session.h"
+#include "voice/voice_benchmark.h"
+
+#include "json.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using edf::voice::InferenceEngineVoice;
+using edf::voice::VoiceBackend;
+
+struct Options {
+    std::filesystem::path models;
+    std::string identifier;
+    std::filesystem::path audio;
+    VoiceBackend backend    = VoiceBackend::TensorFlow;
+    unsigned long modelRate = 16000;
+    std::vector<unsigned long> rates{16000, 44100, 48000};
+    std::vector<size_t> layouts{1, 2};
+    std::chrono::milliseconds chunk{250};
+    float threshold = 0.5f;
+};
+
+int usage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " --models DIR --model IDENTIFIER --audio FILE [--backend tensorflow|onnxruntime] [--model-rate HZ]"
+                 " [--rates HZ,HZ,...] [--layouts N,N,...] [--chunk-ms MS] [--threshold T]\n";
+    return EXIT_FAILURE;
+}
+
+template <typename T> std::vector<T> parseList(const std::string& text) {
+    std::vector<T> values;
+    std::stringstream stream{text};
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(static_cast<T>(std::stoul(item)));
+        }
+    }
+    return values;
+}
+
+// The whole file as mono float32, so every run renders from the same samples without touching the disk
+std::vector<float> readMono(const std::filesystem::path& path, unsigned long& rate) {
+    edf::voice::SndFileSource source{path};
+    rate = source.rate();
+    std::vector<float> mono;
+    std::vector<float> block;
+    edf::voice::AudioBuffer chunk;
+    while (source.read(std::chrono::seconds(10), chunk)) {
+        edf::voice::detail::downmixToMono(chunk, block);
+        mono.insert(mono.end(), block.begin(), block.end());
+    }
+    return mono;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 == argc) {
+            return usage(argv[0]);
+        }
+        const std::string value = argv[++i];
+        if (arg == "--models") {
+            options.models = value;
+        } else if (arg == "--model") {
+            options.identifier = value;
+        } else if (arg == "--audio") {
+            options.audio = value;
+        } else if (arg == "--backend") {
+            options.backend = edf::voice::voiceBackendFromString(value);
+        } else if (arg == "--model-rate") {
+            options.modelRate = std::stoul(value);
+        } else if (arg == "--rates") {
+            options.rates = parseList<unsigned long>(value);
+        } else if (arg == "--layouts") {
+            options.layouts = parseList<size_t>(value);
+        } else if (arg == "--chunk-ms") {
+            options.chunk = std::chrono::milliseconds(std::stoi(value));
+        } else if (arg == "--threshold") {
+            options.threshold = std::stof(value);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (options.models.empty() || options.identifier.empty() || options.audio.empty()) {
+        return usage(argv[0]);
+    }
+
+    std::error_code ec;
+    const auto logsDir = std::filesystem::temp_directory_path(ec) / "x-phy-bench";
+    std::filesystem::create_directories(logsDir, ec);
+    edf::Logger::intialise(logsDir);
+
+    try {
+        unsigned long audioRate = 0;
+        const auto mono         = readMono(options.audio, audioRate);
+
+        InferenceEngineVoice engine;
+        const auto residentBefore = edf::utils::residentBytes();
+        const edf::utils::Timer timer;
+        if (options.backend == VoiceBackend::OnnxRuntime) {
+            engine.loadOnnxModel(options.models.string(), options.identifier, options.modelRate);
+        } else {
+            engine.loadTFModel(options.models.string(), options.identifier, options.modelRate);
+        }
+        const auto loadMs        = std::chrono::duration<double, std::milli>(timer.elapsed()).count();
+        const auto residentAfter = edf::utils::residentBytes();
+
+        nlohmann::json report = {
+            {"backend", edf::voice::toString(options.backend)},
+            {"load_ms", loadMs},
+            {"resident_bytes_added", residentAfter > residentBefore ? residentAfter - residentBefore : 0},
+            {"runs",
+             edf::voice::runVoiceBenchmarkMatrix(
+                 engine, mono, audioRate, options.rates, options.layouts, options.chunk, options.threshold)}};
+        std::cout << report.dump(2) << "\n";
+        return EXIT_SUCCESS;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
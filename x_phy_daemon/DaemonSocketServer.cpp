@@ -0,0 +1,257 @@
+#include "DaemonSocketServer.h"
+
+#include "utils/logger.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+
+namespace edf::daemon {
+
+namespace {
+
+[[noreturn]] void throwErrno(const std::string& what) { throw std::system_error(errno, std::generic_category(), what); }
+
+// Removes a socket left behind by a daemon that did not shut down cleanly. Anything that is not a socket, or a
+// socket another process still accepts connections on, is left alone and bind fails instead.
+void removeStaleSocket(const std::string& path, const sockaddr_un& address) {
+    struct stat info {};
+    if (::lstat(path.c_str(), &info) != 0 || !S_ISSOCK(info.st_mode)) {
+        return;
+    }
+    const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        return;
+    }
+    const bool live = ::connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    const int error = errno;
+    ::close(probe);
+    if (live) {
+        throw std::system_error(std::make_error_code(std::errc::address_in_use), "Daemon socket " + path);
+    }
+    if (error == ECONNREFUSED) {
+        LOG_INFO("Removing stale daemon socket {}", path);
+        ::unlink(path.c_str());
+    }
+}
+
+} // namespace
+
+ClientConnection::ClientConnection(int fd, std::uint64_t id) : fd_(fd), id_(id) {}
+
+ClientConnection::~ClientConnection() { ::close(fd_); }
+
+bool ClientConnection::send(const nlohmann::json& message) {
+    // Invalid UTF-8 (e.g. a non-UTF-8 file name) is replaced rather than failing the whole message
+    auto line = message.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    line.push_back('\n');
+    {
+        std::lock_guard lock{mutex_};
+        if (closed_) {
+            return false;
+        }
+        if (outbox_.size() < maxOutbox) {
+            outbox_.push_back(std::move(line));
+            pending_.notify_one();
+            return true;
+        }
+    }
+    LOG_WARN("Daemon client {} is {} messages behind; disconnecting", id_, maxOutbox);
+    close();
+    return false;
+}
+
+void ClientConnection::close() {
+    {
+        std::lock_guard lock{mutex_};
+        closed_ = true;
+    }
+    pending_.notify_all();
+    // Wakes the reader blocked in recv and the writer blocked in send
+    ::shutdown(fd_, SHUT_RDWR);
+}
+
+void ClientConnection::finish() {
+    {
+        std::lock_guard lock{mutex_};
+        finishing_ = true;
+    }
+    pending_.notify_all();
+}
+
+void ClientConnection::writeLoop() {
+    std::unique_lock lock{mutex_};
+    while (true) {
+        pending_.wait(lock, [this] { return closed_ || finishing_ || !outbox_.empty(); });
+        if (closed_) {
+            return;
+        }
+        if (outbox_.empty()) {
+            lock.unlock();
+            close();
+            return;
+        }
+        auto line = std::move(outbox_.front());
+        outbox_.pop_front();
+        lock.unlock();
+        for (size_t sent = 0; sent < line.size();) {
+            const auto n = ::send(fd_, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                close();
+                return;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        lock.lock();
+    }
+}
+
+DaemonSocketServer::DaemonSocketServer(std::filesystem::path socketPath, RequestHandler handler)
+    : socketPath_(std::move(socketPath)), handler_(std::move(handler)) {}
+
+DaemonSocketServer::~DaemonSocketServer() {
+    std::vector<Connection> clients;
+    {
+        std::lock_guard lock{mutex_};
+        clients.swap(clients_);
+    }
+    for (auto& client : clients) {
+        client->close();
+        client->reader_.join();
+        client->writer_.join();
+    }
+    if (listenFd_ >= 0) {
+        ::close(listenFd_);
+    }
+}
+
+void DaemonSocketServer::run(std::atomic_bool& run) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const auto path    = socketPath_.string();
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::system_error(std::make_error_code(std::errc::filename_too_long), "Daemon socket " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        throwErrno("Cannot create daemon socket");
+    }
+    removeStaleSocket(path, address);
+    // Created without permissions for others, so no other user can drive detection in between bind and chmod
+    const auto oldMask = ::umask(S_IRWXO);
+    const int bound    = ::bind(listenFd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    ::umask(oldMask);
+    if (bound < 0) {
+        throwErrno("Cannot bind daemon socket " + path);
+    }
+    ::chmod(path.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+    if (::listen(listenFd_, 16) < 0) {
+        throwErrno("Cannot listen on daemon socket " + path);
+    }
+    LOG_INFO("Daemon listening on {}", path);
+
+    while (run) {
+        pollfd listener{listenFd_, POLLIN, 0};
+        const int ready = ::poll(&listener, 1, 200);
+        reap();
+        if (ready <= 0) {
+            if (ready < 0 && errno != EINTR) {
+                throwErrno("Daemon socket poll failed");
+            }
+            continue;
+        }
+        const int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        std::lock_guard lock{mutex_};
+        auto client     = std::make_shared<ClientConnection>(fd, nextClientId_++);
+        client->writer_ = std::thread([raw = client.get()] { raw->writeLoop(); });
+        client->reader_ = std::thread([this, client] { readLoop(client); });
+        clients_.push_back(client);
+        LOG_DEBUG("Daemon client {} connected", client->id());
+    }
+
+    ::unlink(path.c_str());
+}
+
+void DaemonSocketServer::readLoop(const Connection& client) {
+    std::string buffer;
+    char chunk[4096];
+    while (!client->closed()) {
+        const auto n = ::recv(client->fd_, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0) {
+            // The client has sent its last request; answer it before hanging up
+            client->finish();
+            LOG_DEBUG("Daemon client {} finished", client->id());
+            return;
+        }
+        if (n < 0) {
+            break;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+
+        size_t start = 0;
+        for (size_t end; (end = buffer.find('\n', start)) != std::string::npos; start = end + 1) {
+            const std::string_view line(buffer.data() + start, end - start);
+            if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+                continue;
+            }
+            nlohmann::json response;
+            try {
+                const auto request = nlohmann::json::parse(line);
+                response           = handler_(client, request);
+            } catch (const nlohmann::json::exception& e) {
+                response = {{"ok", false}, {"error", std::string("Malformed request: ") + e.what()}};
+            } catch (const std::exception& e) {
+                // A failing request must not take the reader thread, and with it the process, down
+                LOG_ERROR("Daemon client {} request failed: {}", client->id(), e.what());
+                response = {{"ok", false}, {"error", e.what()}};
+            }
+            if (!response.is_null()) {
+                client->send(response);
+            }
+        }
+        buffer.erase(0, start);
+        if (buffer.size() > maxRequestBytes) {
+            LOG_WARN("Daemon client {} sent a request over {} bytes; disconnecting", client->id(), maxRequestBytes);
+            break;
+        }
+    }
+    client->close();
+    LOG_DEBUG("Daemon client {} disconnected", client->id());
+}
+
+void DaemonSocketServer::reap() {
+    std::vector<Connection> finished;
+    {
+        std::lock_guard lock{mutex_};
+        auto split = std::stable_partition(clients_.begin(), clients_.end(), [](const Connection& client) {
+            return !client->closed();
+        });
+        finished.assign(split, clients_.end());
+        clients_.erase(split, clients_.end());
+    }
+    for (auto& client : finished) {
+        client->reader_.join();
+        client->writer_.join();
+    }
+}
+
+} // namespace edf::daemon
@@ -0,0 +1,124 @@
+/**
+ * @file DaemonSocketServer.h
+ * @brief Unix domain socket server speaking JSON lines for the headless detection daemon.
+ *
+ * Every message in either direction is one JSON object on one line. Each client gets a reader thread that hands its
+ * requests to the daemon and a writer thread that drains its outbox, so a slow client never stalls the detection
+ * threads publishing results to it.
+ */
+
+#pragma once
+
+#include "json.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace edf::daemon {
+
+/**
+ * @class ClientConnection
+ * @brief One connected client; `send` may be called from any thread.
+ */
+class ClientConnection {
+  public:
+    /// Messages a client may fall behind by before it is disconnected, rather than losing messages silently.
+    static constexpr size_t maxOutbox = 4096;
+
+    ClientConnection(int fd, std::uint64_t id);
+    ~ClientConnection();
+
+    ClientConnection(const ClientConnection&)            = delete;
+    ClientConnection& operator=(const ClientConnection&) = delete;
+
+    std::uint64_t id() const { return id_; }
+
+    /// Queues `message` as one line; false once the connection is closed.
+    bool send(const nlohmann::json& message);
+
+    /// Stops both directions; pending reads and writes return.
+    void close();
+
+    /// Closes the connection once the queued messages are written, e.g. after the client ended its requests.
+    void finish();
+
+    bool closed() const { return closed_; }
+
+  private:
+    friend class DaemonSocketServer;
+
+    void writeLoop();
+
+    const int fd_;
+    const std::uint64_t id_;
+    std::atomic_bool closed_{false};
+    bool finishing_ = false;
+    std::mutex mutex_;
+    std::condition_variable pending_;
+    std::deque<std::string> outbox_;
+    std::thread reader_;
+    std::thread writer_;
+};
+
+using Connection = std::shared_ptr<ClientConnection>;
+
+/**
+ * @class DaemonSocketServer
+ * @brief Accepts clients on a socket path and dispatches their requests.
+ */
+class DaemonSocketServer {
+  public:
+    /**
+     * @brief Handles one request and returns the response sent back to the client that made it.
+     *
+     * A null response sends nothing, for handlers that reply through `client` themselves.
+     */
+    using RequestHandler = std::function<nlohmann::json(const Connection& client, const nlohmann::json& request)>;
+
+    /// Longest request line accepted; longer ones close the connection.
+    static constexpr size_t maxRequestBytes = 1 << 20;
+
+    /**
+     * @param socketPath Created on `run`. A socket left by a previous process is replaced only when nothing accepts
+     *                   connections on it; `run` refuses to take over a live daemon's socket or any other file.
+     */
+    DaemonSocketServer(std::filesystem::path socketPath, RequestHandler handler);
+    ~DaemonSocketServer();
+
+    DaemonSocketServer(const DaemonSocketServer&)            = delete;
+    DaemonSocketServer& operator=(const DaemonSocketServer&) = delete;
+
+    /**
+     * @brief Listens and serves clients until `run` is cleared, then disconnects them and removes the socket.
+     *
+     * The socket is only accessible to the daemon's user and group.
+     *
+     * @throws std::system_error if the socket cannot be created or bound, or another daemon is listening on it.
+     */
+    void run(std::atomic_bool& run);
+
+  private:
+    void readLoop(const Connection& client);
+
+    // Joins the threads of clients that have disconnected
+    void reap();
+
+    const std::filesystem::path socketPath_;
+    const RequestHandler handler_;
+    int listenFd_ = -1;
+
+    std::mutex mutex_;
+    std::vector<Connection> clients_;
+    std::uint64_t nextClientId_ = 1;
+};
+
+} // namespace edf::daemon
@@ -0,0 +1,468 @@
+#include "DetectionDaemon.h"
+
+#include "utils/logger.h"
+#include "voice/audio_source.h"
+#include "voice/capture_backpressure.h"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <system_error>
+#include <variant>
+
+namespace edf::daemon {
+
+namespace {
+
+using Controller = ApplicationController;
+
+// Indexed by DetectionDaemon's Source and State
+constexpr const char* sourceNames[] = {"video", "audio", "media", "directory"};
+constexpr const char* stateNames[]  = {"running", "stopping", "done", "stopped", "failed"};
+
+nlohmann::json toEvent(const std::vector<Controller::ScreenshotFace>& faces) {
+    auto list = nlohmann::json::array();
+    for (const auto& face : faces) {
+        list.push_back({{"fake", face.isFake},
+                        {"score", face.probFakeScore},
+                        {"contour", face.contourRatio},
+                        {"width", face.rawPixels.cols},
+                        {"height", face.rawPixels.rows}});
+    }
+    return {{"event", "faces"}, {"faces", std::move(list)}};
+}
+
+nlohmann::json toEvent(Controller::FaceClassification classification) {
+    const bool fake = classification == Controller::FaceClassification::Deepfake;
+    return {{"event", "face_classification"}, {"classification", fake ? "deepfake" : "real"}};
+}
+
+nlohmann::json toEvent(Controller::VoiceClassification classification) {
+    static constexpr const char* names[] = {"deepfake", "real", "analyzing", "invalid", "none"};
+    return {{"event", "voice_classification"}, {"classification", names[static_cast<int>(classification)]}};
+}
+
+nlohmann::json toEvent(const Controller::VoiceGraphScore& score) {
+    return {{"event", "voice_score"}, {"score", score.score}};
+}
+
+nlohmann::json toEvent(const Controller::VoiceStreamScore& score) {
+    return {{"event", "voice_score"},
+            {"stream", score.stream},
+            {"score", score.score},
+            {"fake_proportion", score.fakeProportion}};
+}
+
+nlohmann::json toEvent(const FusedSegment& segment) {
+    auto optional = [](const std::optional<float>& value) {
+        return value ? nlohmann::json(*value) : nlohmann::json(nullptr);
+    };
+    return {{"event", "segment"},
+            {"start_ms", segment.start.count()},
+            {"end_ms", segment.end.count()},
+            {"voice_score", optional(segment.voiceScore)},
+            {"voice_windows", segment.voiceWindows},
+            {"fake_voice_windows", segment.fakeVoiceWindows},
+            {"face_score", optional(segment.faceScore)},
+            {"video_frames", segment.videoFrames},
+            {"faces", segment.faces},
+            {"fake_faces", segment.fakeFaces}};
+}
+
+nlohmann::json toEvent(const Controller::ResultNotification& result) {
+    return {{"event", "result"}, {"path", result.result_path.string()}, {"last", result.isLast}};
+}
+
+nlohmann::json toEvent(const Controller::FileScanProgress& progress) {
+    return {{"event", "progress"},
+            {"frames_analysed", progress.framesAnalysed},
+            {"total_frames", progress.totalFrames},
+            {"frames_per_sec", progress.framesPerSec},
+            {"resume_frame", progress.resumeFrame}};
+}
+
+nlohmann::json toEvent(const Controller::MediaTrackProblem& problem) {
+    return {{"event", "warning"}, {"track", problem.track}, {"message", problem.reason}};
+}
+
+template <typename... Updates> nlohmann::json toEvent(const std::variant<Updates...>& update) {
+    return std::visit([](const auto& alternative) { return toEvent(alternative); }, update);
+}
+
+nlohmann::json reply(const nlohmann::json& request, nlohmann::json response) {
+    if (request.contains("id")) {
+        response["id"] = request["id"];
+    }
+    return response;
+}
+
+nlohmann::json failure(const nlohmann::json& request, const std::string& error) {
+    return reply(request, {{"ok", false}, {"error", error}});
+}
+
+long long toUnixSeconds(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+DetectionDaemon::DetectionDaemon(ApplicationController& controller) : controller_(controller) {}
+
+DetectionDaemon::~DetectionDaemon() {
+    stopAll();
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard lock{mutex_};
+        for (auto& job : jobs_) {
+            if (job->worker.joinable()) {
+                workers.push_back(std::move(job->worker));
+            }
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+nlohmann::json DetectionDaemon::handle(const Connection& client, const nlohmann::json& request) {
+    if (!request.is_object()) {
+        return failure(request, "Requests must be JSON objects");
+    }
+    try {
+        const auto cmd = request.value("cmd", std::string{});
+        if (cmd == "start") {
+            return start(client, request);
+        }
+        if (cmd == "stop") {
+            return stop(request);
+        }
+        if (cmd == "status") {
+            return status(request);
+        }
+        if (cmd == "subscribe") {
+            return subscribe(client, request);
+        }
+        return failure(request, "Unknown cmd '" + cmd + "'");
+    } catch (const nlohmann::json::exception& e) {
+        return failure(request, std::string("Malformed request: ") + e.what());
+    }
+}
+
+void DetectionDaemon::stopAll() {
+    std::lock_guard lock{mutex_};
+    for (auto& job : jobs_) {
+        if (job->state == State::Running) {
+            job->state = State::Stopping;
+            job->run   = false;
+        }
+    }
+}
+
+nlohmann::json DetectionDaemon::start(const Connection& client, const nlohmann::json& request) {
+    const auto sourceText = request.at("source").get<std::string>();
+    const auto found      = std::find(std::begin(sourceNames), std::end(sourceNames), sourceText);
+    if (found == std::end(sourceNames)) {
+        return failure(request, "Unknown source '" + sourceText + "'");
+    }
+    const auto source = static_cast<Source>(found - std::begin(sourceNames));
+    const std::filesystem::path path(request.at("path").get<std::string>());
+    std::error_code ec;
+    const auto type = std::filesystem::status(path, ec).type();
+    if (type == std::filesystem::file_type::not_found || ec) {
+        return failure(request, path.string() + " does not exist");
+    }
+    if ((type == std::filesystem::file_type::directory) != (source == Source::Directory)) {
+        const bool wantsDirectory = source == Source::Directory;
+        return failure(request, path.string() + (wantsDirectory ? " is not a directory" : " is a directory"));
+    }
+    const auto mode = request.value("mode", std::string("web"));
+    if (mode != "web" && mode != "call") {
+        return failure(request, "Unknown mode '" + mode + "'");
+    }
+    const bool isBackgroundRun = request.value("background", false);
+
+    reap();
+    const bool needsVideo = source != Source::Audio;
+    const bool needsVoice = source == Source::Audio || source == Source::Media;
+    std::lock_guard lock{mutex_};
+    if ((needsVideo && videoBusy_) || (needsVoice && voiceBusy_)) {
+        return failure(request, std::string("The ") + (needsVideo && videoBusy_ ? "video" : "voice") +
+                                    " engine is busy with another job");
+    }
+    videoBusy_ |= needsVideo;
+    voiceBusy_ |= needsVoice;
+
+    auto job             = std::make_unique<Job>();
+    job->id              = nextJobId_++;
+    job->source          = source;
+    job->path            = path;
+    job->liveCall        = mode == "call";
+    job->isBackgroundRun = isBackgroundRun;
+    job->startedAt       = std::chrono::system_clock::now();
+
+    auto& started = *jobs_.emplace_back(std::move(job));
+    try {
+        started.worker = std::thread([this, &started] { runJob(started); });
+    } catch (const std::system_error& e) {
+        LOG_ERROR("Cannot start a worker for daemon job {}: {}", started.id, e.what());
+        jobs_.pop_back();
+        // Both flags were clear for the engines this job needed, see the busy check above
+        videoBusy_ = videoBusy_ && !needsVideo;
+        voiceBusy_ = voiceBusy_ && !needsVoice;
+        return failure(request, std::string("Cannot start the job: ") + e.what());
+    }
+    subscriptions_.push_back({started.id, client});
+    // Answered while mutex_ is still held, so the client knows the job id before the worker can publish an event
+    client->send(reply(request, {{"ok", true}, {"job", started.id}}));
+    LOG_INFO("Daemon job {}: {} scan of {}", started.id, sourceText, path.string());
+    return nullptr;
+}
+
+nlohmann::json DetectionDaemon::stop(const nlohmann::json& request) {
+    const auto id = request.at("job").get<std::uint64_t>();
+    std::lock_guard lock{mutex_};
+    for (auto& job : jobs_) {
+        if (job->id == id) {
+            if (job->state == State::Running) {
+                job->state = State::Stopping;
+                job->run   = false;
+            }
+            return reply(request, {{"ok", true}, {"state", stateNames[static_cast<int>(job->state)]}});
+        }
+    }
+    return failure(request, "No job " + std::to_string(id));
+}
+
+nlohmann::json DetectionDaemon::status(const nlohmann::json& request) {
+    reap();
+    std::optional<std::uint64_t> id;
+    if (request.contains("job")) {
+        id = request["job"].get<std::uint64_t>();
+    }
+    auto list = nlohmann::json::array();
+    std::lock_guard lock{mutex_};
+    for (const auto& job : jobs_) {
+        if (!id || job->id == *id) {
+            list.push_back(describe(*job));
+        }
+    }
+    if (id && list.empty()) {
+        return failure(request, "No job " + std::to_string(*id));
+    }
+    return reply(request,
+                 {{"ok", true}, {"jobs", std::move(list)}, {"video_busy", videoBusy_}, {"voice_busy", voiceBusy_}});
+}
+
+nlohmann::json DetectionDaemon::subscribe(const Connection& client, const nlohmann::json& request) {
+    Subscription subscription{std::nullopt, client};
+    std::lock_guard lock{mutex_};
+    if (request.contains("job")) {
+        const auto id = request["job"].get<std::uint64_t>();
+        if (std::none_of(jobs_.begin(), jobs_.end(), [id](const auto& job) { return job->id == id; })) {
+            return failure(request, "No job " + std::to_string(id));
+        }
+        subscription.job = id;
+    }
+    subscriptions_.push_back(std::move(subscription));
+    return reply(request, {{"ok", true}});
+}
+
+void DetectionDaemon::runJob(Job& job) {
+    bool complete = false;
+    std::string error;
+    nlohmann::json summary;
+    auto callback = [this, &job](const auto& update) { publish(job, toEvent(update)); };
+    try {
+        switch (job.source) {
+        case Source::Video:
+            setupVideo(job.liveCall);
+            complete = controller_.runFileDetection(job.run, job.path, job.isBackgroundRun, callback);
+            break;
+        case Source::Audio:
+            complete = runAudioJob(job);
+            break;
+        case Source::Media:
+            setupVideo(job.liveCall);
+            setupVoice(job.liveCall);
+            complete = controller_.runMediaDetection(job.run, job.path, job.isBackgroundRun, callback);
+            break;
+        case Source::Directory: {
+            setupVideo(job.liveCall);
+            const auto stats = controller_.runDirectoryScan(job.run, job.path, job.isBackgroundRun, callback);
+            summary          = {{"queued", stats.queued},
+                                {"resumed", stats.resumed},
+                                {"skipped", stats.skipped},
+                                {"done", stats.done},
+                                {"failed", stats.failed}};
+            complete         = job.run;
+            break;
+        }
+        }
+    } catch (const InferenceEnvironmentError&) {
+        error = "Inference environment setup failed; check that the model files are present";
+    } catch (const std::exception& e) {
+        error = e.what();
+    } catch (...) {
+        error = "Unknown error";
+    }
+
+    nlohmann::json event = {{"event", "finished"}};
+    {
+        std::lock_guard lock{mutex_};
+        job.state = !error.empty() ? State::Failed : complete ? State::Done : State::Stopped;
+        job.error = error;
+        if (job.source != Source::Audio) {
+            videoBusy_ = false;
+        }
+        if (job.source == Source::Audio || job.source == Source::Media) {
+            voiceBusy_ = false;
+        }
+        event["state"] = stateNames[static_cast<int>(job.state)];
+    }
+    if (!error.empty()) {
+        LOG_ERROR("Daemon job {} failed: {}", job.id, error);
+        event["error"] = error;
+    }
+    if (!summary.is_null()) {
+        event["files"] = std::move(summary);
+    }
+    LOG_INFO("Daemon job {} {}", job.id, event["state"].get<std::string>());
+    publish(job, std::move(event));
+}
+
+bool DetectionDaemon::runAudioJob(Job& job) {
+    setupVoice(job.liveCall);
+    voice::SndFileSource source(job.path);
+    // Block whatever [voice] says: a file must be scored in full, and the pump sleeps while the queue is full
+    voice::AudioCaptureChannel channel(1024, voice::OverflowPolicy::Block);
+
+    // As the desktop app: 1 s capture windows streamed in 250 ms chunks
+    constexpr int captureDurationSecs = 1;
+    constexpr auto captureChunk       = std::chrono::milliseconds(250);
+    // The session ends on endOfInput once the file is scored; this only bounds a source that never ends
+    constexpr size_t maxSessionSecs = 7 * 24 * 3600;
+
+    std::atomic_bool delivered{false};
+    std::atomic_bool endOfInput{false};
+    std::thread pump([&] {
+        delivered = voice::pumpAudioSource(source,
+                                           job.run,
+                                           captureChunk,
+                                           voice::Pacing::Fast,
+                                           channel.queue,
+                                           &channel.pool,
+                                           &channel.backpressure);
+        endOfInput = true;
+    });
+
+    const auto mode = job.liveCall ? AudioMode::LiveCall : AudioMode::WebSurfing;
+    try {
+        controller_.runVoiceDetection(job.run,
+                                      mode,
+                                      job.isBackgroundRun,
+                                      maxSessionSecs,
+                                      captureDurationSecs,
+                                      channel.queue,
+                                      [this, &job](const auto& update) { publish(job, toEvent(update)); },
+                                      &channel.pool,
+                                      &channel.backpressure,
+                                      &endOfInput);
+    } catch (...) {
+        job.run = false;
+        pump.join();
+        throw;
+    }
+    const bool complete = delivered && job.run;
+    job.run             = false;
+    pump.join();
+    return complete;
+}
+
+void DetectionDaemon::setupVideo(bool liveCall) {
+    if (videoLiveCall_ != liveCall) {
+        videoLiveCall_.reset();
+        controller_.setupInferenceEnv(liveCall ? VideoMode::LiveCall : VideoMode::WebSurfing);
+        videoLiveCall_ = liveCall;
+    }
+}
+
+void DetectionDaemon::setupVoice(bool liveCall) {
+    if (voiceLiveCall_ != liveCall) {
+        voiceLiveCall_.reset();
+        controller_.setupVoiceInferenceEnv(liveCall ? AudioMode::LiveCall : AudioMode::WebSurfing);
+        voiceLiveCall_ = liveCall;
+    }
+}
+
+void DetectionDaemon::publish(Job& job, nlohmann::json event) {
+    event["job"] = job.id;
+    std::vector<Connection> clients;
+    {
+        std::lock_guard lock{mutex_};
+        if (event["event"] == "progress") {
+            job.progress = event;
+        }
+        std::set<ClientConnection*> seen;
+        auto expired = std::remove_if(subscriptions_.begin(), subscriptions_.end(), [&](const Subscription& sub) {
+            auto client = sub.client.lock();
+            if (!client || client->closed()) {
+                return true;
+            }
+            if ((!sub.job || *sub.job == job.id) && seen.insert(client.get()).second) {
+                clients.push_back(std::move(client));
+            }
+            return false;
+        });
+        subscriptions_.erase(expired, subscriptions_.end());
+    }
+    for (const auto& client : clients) {
+        client->send(event);
+    }
+}
+
+nlohmann::json DetectionDaemon::describe(const Job& job) const {
+    nlohmann::json description = {{"job", job.id},
+                                  {"source", sourceNames[static_cast<int>(job.source)]},
+                                  {"path", job.path.string()},
+                                  {"mode", job.liveCall ? "call" : "web"},
+                                  {"state", stateNames[static_cast<int>(job.state)]},
+                                  {"started_at", toUnixSeconds(job.startedAt)},
+                                  {"progress", job.progress}};
+    if (!job.error.empty()) {
+        description["error"] = job.error;
+    }
+    return description;
+}
+
+void DetectionDaemon::reap() {
+    auto finished = [](const Job& job) {
+        return job.state == State::Done || job.state == State::Stopped || job.state == State::Failed;
+    };
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard lock{mutex_};
+        for (auto& job : jobs_) {
+            if (finished(*job) && job->worker.joinable()) {
+                workers.push_back(std::move(job->worker));
+            }
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::lock_guard lock{mutex_};
+    auto count = static_cast<size_t>(
+        std::count_if(jobs_.begin(), jobs_.end(), [&](const auto& job) { return finished(*job); }));
+    // Jobs are kept in start order, so the first finished ones are the oldest
+    for (auto it = jobs_.begin(); count > maxFinishedJobs && it != jobs_.end();) {
+        if (finished(**it) && !(*it)->worker.joinable()) {
+            it = jobs_.erase(it);
+            --count;
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace edf::daemon
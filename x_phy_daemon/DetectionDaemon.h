@@ -0,0 +1,120 @@
+/**
+ * @file DetectionDaemon.h
+ * @brief Headless detection jobs over `edf::ApplicationController`, driven by JSON-lines requests.
+ *
+ * Requests carry a `cmd` and an optional `id` that is echoed in the response:
+ *
+ * - `{"cmd":"start","source":"video|audio|media|directory","path":"...","mode":"web|call","background":false}`
+ *   starts a job and answers `{"ok":true,"job":N}`. `video` scans a video file (`runFileDetection`), `audio` a
+ *   WAV/FLAC file through the voice engine, `media` both tracks of a file (`runMediaDetection`) and `directory`
+ *   every video file under a directory (`runDirectoryScan`). The client is subscribed to the job's events.
+ * - `{"cmd":"stop","job":N}` asks a job to stop; its `finished` event follows.
+ * - `{"cmd":"status"}` or `{"cmd":"status","job":N}` lists the jobs with their state and latest progress.
+ * - `{"cmd":"subscribe"}` or `{"cmd":"subscribe","job":N}` streams the events of every job, or of one job.
+ *
+ * Failed requests answer `{"ok":false,"error":"..."}`. Events are `{"event":"...","job":N,...}` with the event
+ * names `faces`, `face_classification`, `voice_classification`, `voice_score`, `segment`, `progress`, `result`,
+ * `warning` and `finished`. `warning` (`track`, `message`) reports a track a `media` job cannot analyse, e.g. audio
+ * when OpenCV was built without GStreamer; the job carries on with the other track. A job needs the video engine,
+ * the voice engine or both (`media`); a job whose engine is in use by another job is refused rather than queued.
+ */
+
+#pragma once
+
+#include "DaemonSocketServer.h"
+
+#include "application_controller.h"
+
+#include "json.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace edf::daemon {
+
+/**
+ * @class DetectionDaemon
+ * @brief Runs detection jobs on their own threads and publishes their results to subscribed clients.
+ */
+class DetectionDaemon {
+  public:
+    /// Finished jobs kept for `status`; older ones are forgotten.
+    static constexpr size_t maxFinishedJobs = 64;
+
+    explicit DetectionDaemon(ApplicationController& controller);
+
+    /// Stops every job and waits for them.
+    ~DetectionDaemon();
+
+    DetectionDaemon(const DetectionDaemon&)            = delete;
+    DetectionDaemon& operator=(const DetectionDaemon&) = delete;
+
+    /// `DaemonSocketServer::RequestHandler`.
+    nlohmann::json handle(const Connection& client, const nlohmann::json& request);
+
+    /// Asks every job to stop, e.g. on SIGTERM.
+    void stopAll();
+
+  private:
+    enum class Source { Video, Audio, Media, Directory };
+    enum class State { Running, Stopping, Done, Stopped, Failed };
+
+    struct Job {
+        std::uint64_t id = 0;
+        Source source    = Source::Video;
+        std::filesystem::path path;
+        bool liveCall        = false; ///< "call" mode: live call thresholds instead of web surfing ones
+        bool isBackgroundRun = false;
+        State state          = State::Running;
+        std::string error;
+        nlohmann::json progress; ///< Latest progress event, null before the first one
+        std::chrono::system_clock::time_point startedAt;
+        std::atomic_bool run{true};
+        std::thread worker;
+    };
+
+    struct Subscription {
+        std::optional<std::uint64_t> job; ///< Unset for every job
+        std::weak_ptr<ClientConnection> client;
+    };
+
+    nlohmann::json start(const Connection& client, const nlohmann::json& request);
+    nlohmann::json stop(const nlohmann::json& request);
+    nlohmann::json status(const nlohmann::json& request);
+    nlohmann::json subscribe(const Connection& client, const nlohmann::json& request);
+
+    void runJob(Job& job);
+    bool runAudioJob(Job& job);
+    void setupVideo(bool liveCall);
+    void setupVoice(bool liveCall);
+
+    void publish(Job& job, nlohmann::json event);
+    nlohmann::json describe(const Job& job) const;
+
+    // Joins the workers of finished jobs and forgets the oldest of them
+    void reap();
+
+    ApplicationController& controller_;
+
+    mutable std::mutex mutex_;
+    std::deque<std::unique_ptr<Job>> jobs_;
+    std::vector<Subscription> subscriptions_;
+    std::uint64_t nextJobId_ = 1;
+    bool videoBusy_          = false;
+    bool voiceBusy_          = false;
+
+    // Mode each engine was last set up for; touched only by the job holding the engine
+    std::optional<bool> videoLiveCall_;
+    std::optional<bool> voiceLiveCall_;
+};
+
+} // namespace edf::daemon
@@ -0,0 +1,100 @@
+// Headless detection daemon: serves DetectionDaemon over a Unix domain socket until SIGINT/SIGTERM.
+//
+// Usage: x_phy_daemon [--socket PATH] [--output DIR] [--config FILE]
+
+#include "DaemonSocketServer.h"
+#include "DetectionDaemon.h"
+
+#include "application_controller.h"
+#include "utils/logger.h"
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+
+std::atomic_bool running{true};
+
+void onSignal(int) { running = false; }
+
+std::filesystem::path defaultSocketPath() {
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    return std::filesystem::path(runtimeDir ? runtimeDir : "/tmp") / "x-phy-daemon.sock";
+}
+
+int usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--socket PATH] [--output DIR] [--config FILE]\n";
+    return EXIT_FAILURE;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::filesystem::path socketPath = defaultSocketPath();
+    std::filesystem::path outputDir  = "x-phy-output";
+    std::filesystem::path configPath = "config.toml";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 == argc) {
+            return usage(argv[0]);
+        }
+        if (arg == "--socket") {
+            socketPath = argv[++i];
+        } else if (arg == "--output") {
+            outputDir = argv[++i];
+        } else if (arg == "--config") {
+            configPath = argv[++i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(outputDir, ec);
+    edf::Logger::intialise(outputDir);
+
+    static_assert(std::atomic_bool::is_always_lock_free, "the signal handler stores to `running`");
+    struct sigaction action {};
+    action.sa_handler = onSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::unique_ptr<edf::ApplicationController> controller;
+    try {
+        controller = std::make_unique<edf::ApplicationController>(outputDir, configPath);
+    } catch (const edf::license_manager::LicenseValidationFailure& e) {
+        LOG_CRITICAL("License validation failed (reason {})", static_cast<int>(e.reason));
+        std::cerr << "License validation failed\n";
+        return EXIT_FAILURE;
+    } catch (const edf::config_reader::ParseError&) {
+        LOG_CRITICAL("Cannot parse config file {}", configPath.string());
+        std::cerr << "Cannot parse config file " << configPath.string() << "\n";
+        return EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        LOG_CRITICAL("Cannot create the application controller: {}", e.what());
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    try {
+        edf::daemon::DetectionDaemon daemon(*controller);
+        edf::daemon::DaemonSocketServer server(socketPath, [&daemon](const auto& client, const auto& request) {
+            return daemon.handle(client, request);
+        });
+        server.run(running);
+        LOG_INFO("Daemon shutting down");
+        daemon.stopAll();
+    } catch (const std::exception& e) {
+        LOG_CRITICAL("Daemon failed: {}", e.what());
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
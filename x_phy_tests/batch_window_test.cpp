@@ -0,0 +1,83 @@
+// Batched voice windows against the windows scored one chunk at a time: with the sliding buffer sized by
+// batchHistoryLength, a batch of K windows read at end offsets over the buffer must equal the windows read after each
+// of the K chunks, as InferenceEngineVoice::loadAudioBuffers relies on.
+
+#include "test_support.h"
+
+#include "utils/ring_buffer.h"
+#include "voice/hop_scheduler.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+using edf::utils::RingBuffer;
+
+std::vector<float> chunkOf(size_t length, float& next) {
+    std::vector<float> chunk(length);
+    for (auto& sample : chunk) {
+        sample = next++;
+    }
+    return chunk;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random{35};
+
+    for (size_t windowLength : {16, 400, 16000}) {
+        for (size_t maxBatch : {1, 2, 4, 8}) {
+            for (int trial = 0; trial < 20; ++trial) {
+                const size_t maxChunk = 1 + random() % (windowLength * 2);
+                // Audio already buffered before the backlog, from none to more than a window
+                const size_t before = random() % (windowLength * 2);
+                std::vector<std::vector<float>> chunks(1 + random() % maxBatch);
+                float next = 1.0f;
+                const auto history = chunkOf(before, next);
+                for (auto& chunk : chunks) {
+                    chunk = chunkOf(1 + random() % maxChunk, next);
+                }
+
+                // One chunk at a time: a buffer holding one window, read after every chunk
+                RingBuffer<float> sequential{windowLength};
+                sequential.append(history);
+                std::vector<std::vector<float>> expected;
+                for (const auto& chunk : chunks) {
+                    sequential.append(chunk);
+                    expected.emplace_back(windowLength);
+                    sequential.copyWindow(expected.back().data(), windowLength);
+                }
+
+                // Batched: every chunk appended first, window i ends where chunk i ended
+                RingBuffer<float> batched{0};
+                batched.reset(edf::voice::batchHistoryLength(windowLength, maxBatch, maxChunk));
+                batched.append(history);
+                for (const auto& chunk : chunks) {
+                    batched.append(chunk);
+                }
+                std::vector<float> window(windowLength);
+                for (size_t i = 0; i < chunks.size(); ++i) {
+                    size_t endOffset = 0;
+                    for (size_t later = i + 1; later < chunks.size(); ++later) {
+                        endOffset += chunks[later].size();
+                    }
+                    batched.copyWindow(window.data(), windowLength, endOffset);
+                    EDF_CHECK(window == expected[i]);
+                }
+            }
+        }
+    }
+
+    // A buffer of one window, as before batching was sized for, pads every older window of the batch
+    RingBuffer<float> oneWindow{8};
+    float next = 1.0f;
+    oneWindow.append(chunkOf(8, next));
+    oneWindow.append(chunkOf(4, next));
+    std::vector<float> older(8);
+    oneWindow.copyWindow(older.data(), older.size(), 4);
+    EDF_CHECK(older.front() == 0.0f);
+
+    return edf::test::result();
+}
@@ -0,0 +1,117 @@
+// CaptureBackpressure policies: Block keeps every chunk and wakes the capture thread as soon as room is made, the
+// dropping policies bound what inference sees.
+
+#include "test_support.h"
+
+#include "voice/capture_backpressure.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using edf::voice::AudioBuffer;
+using edf::voice::CaptureBackpressure;
+using edf::voice::OverflowPolicy;
+
+AudioBuffer chunk(unsigned char value) {
+    AudioBuffer buffer;
+    buffer.rate             = 16000;
+    buffer.channels         = 1;
+    buffer.bytes_per_sample = 1;
+    buffer.samples.assign(160, value);
+    return buffer;
+}
+
+} // namespace
+
+int main() {
+    EDF_CHECK(edf::voice::overflowPolicyFromString("block") == OverflowPolicy::Block);
+    EDF_CHECK(edf::voice::overflowPolicyFromString("drop_oldest") == OverflowPolicy::DropOldest);
+    EDF_CHECK(edf::voice::overflowPolicyFromString("coalesce") == OverflowPolicy::Coalesce);
+    EDF_CHECK(edf::voice::overflowPolicyFromString("") == OverflowPolicy::Block);
+    EDF_CHECK(edf::voice::AudioCaptureChannel{}.backpressure.policy() == OverflowPolicy::Block);
+
+    // Block: the producer stalls at the depth limit and resumes on the consumer's signal, well before the wait's
+    // periodic check of `run`; every chunk arrives in order
+    {
+        moodycamel::ReaderWriterQueue<AudioBuffer> queue{64};
+        CaptureBackpressure backpressure{OverflowPolicy::Block, 2};
+        std::atomic_bool run{true};
+        constexpr int total = 40;
+        std::thread producer([&] {
+            for (int i = 0; i < total; ++i) {
+                backpressure.enqueue(queue, chunk(static_cast<unsigned char>(i)), run);
+            }
+        });
+        std::vector<int> received;
+        AudioBuffer out;
+        const auto start = std::chrono::steady_clock::now();
+        while (received.size() < total && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+            if (backpressure.dequeue(queue, out)) {
+                received.push_back(out.samples.front());
+                EDF_CHECK(queue.size_approx() <= 2);
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        producer.join();
+        EDF_CHECK(received.size() == total);
+        for (size_t i = 0; i < received.size(); ++i) {
+            EDF_CHECK(received[i] == static_cast<int>(i));
+        }
+        // About 38 waits; woken only by the 50 ms timeout they would take about two seconds
+        EDF_CHECK(elapsed < std::chrono::milliseconds(500));
+        EDF_CHECK(backpressure.metrics().dropped == 0);
+    }
+
+    // Block: clearing `run` releases a producer waiting on a consumer that is gone
+    {
+        moodycamel::ReaderWriterQueue<AudioBuffer> queue{8};
+        CaptureBackpressure backpressure{OverflowPolicy::Block, 1};
+        std::atomic_bool run{true};
+        EDF_CHECK(backpressure.enqueue(queue, chunk(0), run));
+        std::atomic_bool returned{false};
+        bool accepted = true;
+        std::thread producer([&] {
+            accepted = backpressure.enqueue(queue, chunk(1), run);
+            returned = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EDF_CHECK(!returned);
+        run = false;
+        producer.join();
+        EDF_CHECK(!accepted);
+    }
+
+    // DropOldest: inference skips to the newest chunks within the limit
+    {
+        moodycamel::ReaderWriterQueue<AudioBuffer> queue{16};
+        CaptureBackpressure backpressure{OverflowPolicy::DropOldest, 2};
+        std::atomic_bool run{true};
+        for (int i = 0; i < 6; ++i) {
+            backpressure.enqueue(queue, chunk(static_cast<unsigned char>(i)), run);
+        }
+        AudioBuffer out;
+        EDF_CHECK(backpressure.dequeue(queue, out) && out.samples.front() == 4);
+        EDF_CHECK(backpressure.metrics().dropped == 4);
+    }
+
+    // Coalesce: everything queued becomes one chunk, trimmed to the newest coalesce limit
+    {
+        moodycamel::ReaderWriterQueue<AudioBuffer> queue{16};
+        CaptureBackpressure backpressure{OverflowPolicy::Coalesce, 2, std::chrono::milliseconds(20)};
+        std::atomic_bool run{true};
+        for (int i = 0; i < 6; ++i) {
+            backpressure.enqueue(queue, chunk(static_cast<unsigned char>(i)), run);
+        }
+        AudioBuffer out;
+        EDF_CHECK(backpressure.dequeue(queue, out));
+        EDF_CHECK(out.samples.size() == 320 && out.samples.front() == 4 && out.samples.back() == 5);
+        EDF_CHECK(queue.size_approx() == 0);
+    }
+
+    return edf::test::result();
+}
@@ -0,0 +1,109 @@
+// Reduced precision conversions of precision.h against their definitions, and the verdict check used to accept a
+// reduced precision classifier.
+
+#include "test_support.h"
+
+#include "vision/precision.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+using edf::vision::Precision;
+
+float bitsToFloat(std::uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Nearest half by brute force over all finite halves, ties to the even mantissa
+std::uint16_t nearestHalf(float value) {
+    std::uint16_t best = 0;
+    double bestError   = std::numeric_limits<double>::infinity();
+    for (std::uint32_t h = 0; h < 0x7c00u; ++h) {
+        const std::uint16_t candidate = static_cast<std::uint16_t>(h | (std::signbit(value) ? 0x8000u : 0u));
+        const double error = std::abs(static_cast<double>(edf::vision::halfToFloat(candidate)) - value);
+        if (error < bestError || (error == bestError && (candidate & 1u) == 0)) {
+            best      = candidate;
+            bestError = error;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    // Every half converts to float and back unchanged, NaNs staying NaNs
+    for (std::uint32_t h = 0; h <= 0xffffu; ++h) {
+        const auto half  = static_cast<std::uint16_t>(h);
+        const float back = edf::vision::halfToFloat(half);
+        if ((h & 0x7c00u) == 0x7c00u && (h & 0x3ffu) != 0) {
+            EDF_CHECK(std::isnan(back) && std::isnan(edf::vision::halfToFloat(edf::vision::floatToHalf(back))));
+        } else {
+            EDF_CHECK(edf::vision::floatToHalf(back) == half);
+        }
+    }
+
+    // Rounding matches the nearest half, including subnormals, ties and overflow to infinity
+    std::mt19937 random{27};
+    std::uniform_real_distribution<float> exponent{-26.0f, 16.5f};
+    for (int i = 0; i < 2000; ++i) {
+        const float value = std::ldexp(1.0f + (random() % 1024) / 1024.0f, static_cast<int>(exponent(random))) *
+                            (random() % 2 ? 1.0f : -1.0f);
+        if (std::abs(value) < 65504.0f) {
+            EDF_CHECK(edf::vision::floatToHalf(value) == nearestHalf(value));
+        }
+    }
+    EDF_CHECK(edf::vision::floatToHalf(65520.0f) == 0x7c00u);
+    EDF_CHECK(edf::vision::floatToHalf(-1e9f) == 0xfc00u);
+    EDF_CHECK(edf::vision::floatToHalf(1.0f + 1.0f / 2048) == 0x3c00u); // tie, rounds to even
+    EDF_CHECK(edf::vision::floatToHalf(1.0f + 3.0f / 2048) == 0x3c02u); // tie, rounds to even
+
+    // bfloat16 keeps the top 16 bits, rounding to nearest even
+    EDF_CHECK(edf::vision::floatToBf16(bitsToFloat(0x3f808000u)) == 0x3f80u);
+    EDF_CHECK(edf::vision::floatToBf16(bitsToFloat(0x3f818000u)) == 0x3f82u);
+    EDF_CHECK(edf::vision::floatToBf16(bitsToFloat(0x3f808001u)) == 0x3f81u);
+    EDF_CHECK(std::isnan(edf::vision::bf16ToFloat(edf::vision::floatToBf16(std::nanf("")))));
+    for (std::uint32_t b = 0; b < 0x7f80u; b += 7) {
+        EDF_CHECK(edf::vision::floatToBf16(edf::vision::bf16ToFloat(static_cast<std::uint16_t>(b))) == b);
+    }
+
+    // Buffer conversions, vectorised when F16C is compiled in, agree with the scalar ones on every element
+    for (auto precision : {Precision::FP16, Precision::BF16}) {
+        std::vector<float> input(1003);
+        for (auto& value : input) {
+            const float mantissa = static_cast<float>(random()) / static_cast<float>(random.max()) - 0.5f;
+            value                = std::ldexp(mantissa, static_cast<int>(random() % 20) - 10);
+        }
+        std::vector<std::uint16_t> reduced(input.size());
+        std::vector<float> output(input.size());
+        edf::vision::convertFromFloat(input.data(), reduced.data(), input.size(), precision);
+        edf::vision::convertToFloat(reduced.data(), output.data(), input.size(), precision);
+        const bool half = precision == Precision::FP16;
+        for (size_t i = 0; i < input.size(); ++i) {
+            const auto expected = half ? edf::vision::floatToHalf(input[i]) : edf::vision::floatToBf16(input[i]);
+            EDF_CHECK(reduced[i] == expected);
+            EDF_CHECK(output[i] == (half ? edf::vision::halfToFloat(expected) : edf::vision::bf16ToFloat(expected)));
+        }
+    }
+
+    EDF_CHECK(edf::vision::modelFileNameFor("m.onnx.encrypted", Precision::FP16) == "m.fp16.onnx.encrypted");
+    EDF_CHECK(edf::vision::modelFileNameFor("m.onnx", Precision::BF16) == "m.bf16.onnx");
+    EDF_CHECK(edf::vision::modelFileNameFor("m.onnx", Precision::FP32) == "m.onnx");
+
+    // A crop only changes verdict when reduced precision moves its score across the threshold
+    const std::vector<float> reference{0.10f, 0.49f, 0.51f, 0.97f};
+    EDF_CHECK(edf::vision::verdictsAgree(reference, {0.12f, 0.47f, 0.55f, 0.99f}, 0.5f));
+    EDF_CHECK(!edf::vision::verdictsAgree(reference, {0.12f, 0.52f, 0.55f, 0.99f}, 0.5f));
+    EDF_CHECK(!edf::vision::verdictsAgree(reference, {0.10f, 0.49f, 0.51f}, 0.5f));
+    EDF_CHECK(edf::vision::verdictsAgree({}, {}, 0.5f));
+
+    return edf::test::result();
+}
@@ -0,0 +1,98 @@
+// Times AudioNormalizer (downmix and polyphase resampling to 16 kHz) on the common WASAPI mix formats, against direct
+// band-limited interpolation of the same audio, as real-time factors on one core.
+//
+// Usage: resampler_bench [RUNS]
+
+#include "resampler_reference.h"
+#include "test_support.h"
+
+#include "voice/audio_buffer.h"
+#include "voice/audio_normalizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr unsigned long modelRate = 16000;
+constexpr size_t chunkMs          = 250;
+
+// One second of stereo noise-like audio in the given sample format
+edf::voice::AudioBuffer capture(unsigned long rate, int bytes) {
+    edf::voice::AudioBuffer buffer;
+    buffer.rate             = rate;
+    buffer.channels         = 2;
+    buffer.bytes_per_sample = bytes;
+    buffer.is_float         = bytes == 4;
+    buffer.samples.resize(rate * 2 * bytes);
+    unsigned state = 1;
+    for (size_t i = 0; i < rate * 2; ++i) {
+        state             = state * 1664525u + 1013904223u;
+        const float value = static_cast<float>(state >> 8) / static_cast<float>(1u << 24) - 0.5f;
+        if (bytes == 4) {
+            std::memcpy(buffer.samples.data() + i * 4, &value, 4);
+        } else {
+            const auto scaled = static_cast<int16_t>(value * 32767.0f);
+            std::memcpy(buffer.samples.data() + i * 2, &scaled, 2);
+        }
+    }
+    return buffer;
+}
+
+// The capture split into the chunks the voice thread receives
+std::vector<edf::voice::AudioBuffer> chunks(const edf::voice::AudioBuffer& audio) {
+    std::vector<edf::voice::AudioBuffer> out;
+    const size_t frameBytes = audio.channels * audio.bytes_per_sample;
+    const size_t chunkBytes = audio.rate * chunkMs / 1000 * frameBytes;
+    for (size_t offset = 0; offset < audio.samples.size(); offset += chunkBytes) {
+        auto chunk = audio;
+        chunk.samples.assign(audio.samples.begin() + offset,
+                             audio.samples.begin() + std::min(offset + chunkBytes, audio.samples.size()));
+        out.push_back(std::move(chunk));
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 20;
+
+    std::printf("%8s %8s %16s %16s %8s\n", "rate", "format", "reference x rt", "normalizer x rt", "speedup");
+    for (unsigned long rate : {44100ul, 48000ul, 96000ul}) {
+        for (int bytes : {4, 2}) {
+            const auto audio  = capture(rate, bytes);
+            const auto pieces = chunks(audio);
+            float sink        = 0.0f;
+
+            // The reference works on the whole mono signal and is slow, so it is timed once
+            edf::voice::AudioNormalizer downmix{rate};
+            const auto mono = downmix.process(audio);
+            const std::vector<float> monoCopy(mono.begin(), mono.end());
+            const double refNs = edf::test::bestNanoseconds(1, [&] {
+                sink += edf::test::referenceResample(monoCopy, rate, modelRate).back();
+            });
+
+            edf::voice::AudioNormalizer normalizer{modelRate};
+            const double optNs = edf::test::bestNanoseconds(runs, [&] {
+                for (const auto& piece : pieces) {
+                    sink += normalizer.process(piece).back();
+                }
+            });
+
+            std::printf("%8lu %8s %16.0f %16.0f %7.0fx%s\n",
+                        rate,
+                        bytes == 4 ? "f32" : "s16",
+                        1e9 / refNs,
+                        1e9 / optNs,
+                        refNs / optNs,
+                        std::isnan(sink) ? " (NaN output)" : "");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file resampler_reference.h
+ * @brief Direct band-limited interpolation, the textbook resampler `voice::PolyphaseResampler` is checked against.
+ *
+ * Every output sample is evaluated at its exact input time with a long Kaiser windowed-sinc in double precision, over
+ * the whole signal at once: no phase bank, no float accumulation and no chunking. It is far too slow for capture but
+ * accurate to well beyond what the model can hear, so its output stands in for the ideal resampled signal.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace edf::test {
+
+namespace detail {
+
+inline double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 100 && term > 1e-16 * sum; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+} // namespace detail
+
+/**
+ * @brief Resamples `in` from `inRate` to `outRate`.
+ *
+ * Output sample `j` is the band-limited input at time `j * inRate / outRate - delay`, in input samples.
+ *
+ * @param delay Shift in input samples, to line the output up with a resampler whose filter delays the signal.
+ * @param halfWidth Filter half length in input samples.
+ */
+inline std::vector<float> referenceResample(const std::vector<float>& in,
+                                            unsigned long inRate,
+                                            unsigned long outRate,
+                                            double delay     = 0.0,
+                                            size_t halfWidth = 256) {
+    constexpr double pi   = 3.14159265358979323846;
+    constexpr double beta = 12.0;
+    // Same cut as the polyphase filter: 92% of the lower Nyquist frequency, in cycles per input sample
+    const double cutoff = 0.5 * 0.92 * std::min(inRate, outRate) / static_cast<double>(inRate);
+    const double norm   = detail::besselI0(beta);
+
+    const size_t count = in.size() * outRate / inRate;
+    std::vector<float> out(count);
+    for (size_t j = 0; j < count; ++j) {
+        const double t   = static_cast<double>(j) * inRate / outRate - delay;
+        const auto first = static_cast<long long>(std::ceil(t - static_cast<double>(halfWidth)));
+        const auto last  = static_cast<long long>(std::floor(t + static_cast<double>(halfWidth)));
+        double sum       = 0.0;
+        for (long long n = std::max(first, 0LL); n <= std::min(last, static_cast<long long>(in.size()) - 1); ++n) {
+            const double x    = static_cast<double>(n) - t;
+            const double arg  = 2.0 * pi * cutoff * x;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(arg) / arg;
+            const double r    = x / static_cast<double>(halfWidth);
+            const double w    = detail::besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / norm;
+            sum += in[static_cast<size_t>(n)] * 2.0 * cutoff * sinc * w;
+        }
+        out[j] = static_cast<float>(sum);
+    }
+    return out;
+}
+
+} // namespace edf::test
@@ -0,0 +1,116 @@
+// PolyphaseResampler against direct band-limited interpolation, and AudioNormalizer's conversions of the WASAPI mix
+// formats to mono float.
+
+#include "resampler_reference.h"
+#include "test_support.h"
+
+#include "voice/audio_buffer.h"
+#include "voice/audio_normalizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+// Tones across the band the model uses, the highest below the filter's transition band
+std::vector<float> tones(unsigned long rate, unsigned long outRate, double seconds) {
+    const double top = 0.35 * static_cast<double>(std::min(rate, outRate));
+    std::vector<float> signal(static_cast<size_t>(seconds * rate));
+    for (size_t i = 0; i < signal.size(); ++i) {
+        const double t = static_cast<double>(i) / rate;
+        signal[i]      = static_cast<float>(0.3 * std::sin(2 * pi * 220 * t) + 0.2 * std::sin(2 * pi * 1250 * t + 1) +
+                                       0.15 * std::sin(2 * pi * top * t + 2));
+    }
+    return signal;
+}
+
+// Signal-to-error ratio in dB, leaving out `margin` samples at each end where the filters see the zero padding
+double snrDb(const std::vector<float>& expected, const std::vector<float>& actual, size_t margin) {
+    double signal = 0.0, error = 0.0;
+    for (size_t i = margin; i + margin < std::min(expected.size(), actual.size()); ++i) {
+        signal += static_cast<double>(expected[i]) * expected[i];
+        error += (static_cast<double>(actual[i]) - expected[i]) * (static_cast<double>(actual[i]) - expected[i]);
+    }
+    return 10.0 * std::log10(signal / std::max(error, 1e-30));
+}
+
+edf::voice::AudioBuffer interleaved(const std::vector<float>& left, const std::vector<float>& right, int bytes) {
+    edf::voice::AudioBuffer buffer;
+    buffer.rate             = 48000;
+    buffer.channels         = 2;
+    buffer.bytes_per_sample = bytes;
+    buffer.is_float         = bytes == 4;
+    buffer.samples.resize(left.size() * 2 * bytes);
+    auto* out = buffer.samples.data();
+    for (size_t i = 0; i < left.size(); ++i) {
+        for (float value : {left[i], right[i]}) {
+            if (bytes == 4) {
+                std::memcpy(out, &value, 4);
+            } else {
+                // Little-endian int16 or packed int24
+                const auto scaled = static_cast<int32_t>(std::lround(value * ((1 << (8 * bytes - 1)) - 1)));
+                for (int b = 0; b < bytes; ++b) {
+                    out[b] = static_cast<unsigned char>((scaled >> (8 * b)) & 0xff);
+                }
+            }
+            out += bytes;
+        }
+    }
+    return buffer;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random{33};
+
+    for (unsigned long rate : {8000ul, 22050ul, 44100ul, 48000ul, 96000ul}) {
+        const auto input = tones(rate, 16000, 0.5);
+
+        edf::voice::PolyphaseResampler whole{rate, 16000};
+        std::vector<float> expected;
+        whole.process(input, expected);
+        const auto reference = edf::test::referenceResample(input, rate, 16000, whole.latency());
+        EDF_CHECK(expected.size() == reference.size());
+        const double snr = snrDb(reference, expected, 600);
+        if (snr < 80.0) {
+            std::cerr << rate << " Hz: " << snr << " dB against the reference\n";
+        }
+        EDF_CHECK(snr >= 80.0);
+
+        // History and phase carry over, so any chunking gives exactly the same samples
+        edf::voice::PolyphaseResampler chunked{rate, 16000};
+        std::vector<float> actual;
+        for (size_t offset = 0; offset < input.size();) {
+            const size_t size = std::min<size_t>(random() % 1500, input.size() - offset);
+            chunked.process({input.data() + offset, size}, actual);
+            offset += size;
+        }
+        EDF_CHECK(actual == expected);
+    }
+
+    // Every sample format downmixes to the channel mean, within its quantisation step
+    const auto left = tones(48000, 48000, 0.05);
+    std::vector<float> right(left.size());
+    for (size_t i = 0; i < left.size(); ++i) {
+        right[i] = -0.5f * left[i];
+    }
+    for (auto [bytes, step] : {std::pair{4, 1e-7}, std::pair{3, 1.0 / 8388607}, std::pair{2, 1.0 / 32767}}) {
+        edf::voice::AudioNormalizer normalizer{48000};
+        const auto mono = normalizer.process(interleaved(left, right, bytes));
+        EDF_CHECK(mono.size() == left.size());
+        double worst = 0.0;
+        for (size_t i = 0; i < std::min(mono.size(), left.size()); ++i) {
+            worst = std::max(worst, std::abs(static_cast<double>(mono[i]) - 0.5 * (left[i] + right[i])));
+        }
+        EDF_CHECK(worst <= step);
+    }
+
+    return edf::test::result();
+}
@@ -0,0 +1,57 @@
+// Times RingBuffer against BoundedDeque on the voice engine's pattern: append one capture chunk of samples to the
+// sliding model window, then copy the window out for inference.
+//
+// Usage: ring_buffer_bench [RUNS]
+
+#include "test_support.h"
+
+#include "utils/bounded_deque.h"
+#include "utils/ring_buffer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    const int runs           = argc > 1 ? std::stoi(argv[1]) : 50;
+    constexpr size_t rate    = 16000;
+    constexpr int chunksEach = 40;
+
+    std::printf("%10s %10s %14s %14s %8s\n", "window", "chunk", "deque us", "ring us", "speedup");
+    for (size_t windowSecs : {2, 4}) {
+        for (size_t chunkMs : {250, 1000}) {
+            const size_t window = windowSecs * rate;
+            const std::vector<float> chunk(chunkMs * rate / 1000, 0.25f);
+            std::vector<float> model(window);
+            float sink = 0.0f;
+
+            edf::utils::BoundedDeque<float> deque{0.0f, window};
+            const double dequeNs = edf::test::bestNanoseconds(runs, [&] {
+                for (int i = 0; i < chunksEach; ++i) {
+                    deque.append(chunk);
+                    std::copy(deque.deque().begin(), deque.deque().end(), model.begin());
+                    sink += model[window - 1 - i];
+                }
+            });
+
+            edf::utils::RingBuffer<float> ring{0.0f, window};
+            const double ringNs = edf::test::bestNanoseconds(runs, [&] {
+                for (int i = 0; i < chunksEach; ++i) {
+                    ring.append(chunk);
+                    ring.copyTo(model.data());
+                    sink += model[window - 1 - i];
+                }
+            });
+
+            std::printf("%9zus %8zums %14.2f %14.2f %7.2fx%s\n",
+                        windowSecs,
+                        chunkMs,
+                        dequeNs / chunksEach / 1000.0,
+                        ringNs / chunksEach / 1000.0,
+                        dequeNs / ringNs,
+                        sink == 0.0f ? " (window not updated)" : "");
+        }
+    }
+    return 0;
+}
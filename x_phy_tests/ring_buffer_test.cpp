@@ -0,0 +1,99 @@
+// RingBuffer against BoundedDeque, whose behaviour it replaces on the voice path: random appends and drops must leave
+// the same window, however the ring wraps.
+
+#include "test_support.h"
+
+#include "utils/bounded_deque.h"
+#include "utils/ring_buffer.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+bool sameWindow(const edf::utils::RingBuffer<int>& ring, const edf::utils::BoundedDeque<int>& deque) {
+    const auto& expected = deque.deque();
+    if (ring.size() != expected.size()) {
+        return false;
+    }
+    const auto copied = ring.toVector();
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (ring[i] != expected[i] || copied[i] != expected[i]) {
+            return false;
+        }
+    }
+    const auto [first, second] = ring.spans();
+    return first.size() + second.size() == expected.size();
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random{31};
+
+    for (size_t maxSize : {1, 5, 8, 13, 64, 1000}) {
+        edf::utils::RingBuffer<int> ring{maxSize};
+        edf::utils::BoundedDeque<int> deque{maxSize};
+        int next = 0;
+        for (int step = 0; step < 5000; ++step) {
+            switch (random() % 4) {
+            case 0:
+                ring.append(next);
+                deque.append(next);
+                ++next;
+                break;
+            case 1: {
+                // BoundedDeque cannot take more than maxSize elements at once
+                std::vector<int> block(random() % (maxSize + 1));
+                for (auto& value : block) {
+                    value = next++;
+                }
+                ring.append(block);
+                deque.append(block);
+                break;
+            }
+            case 2: {
+                const size_t drop = deque.size() == 0 ? 0 : random() % (deque.size() + 1);
+                ring.drop_front(drop);
+                deque.drop_front(drop);
+                break;
+            }
+            default:
+                if (random() % 50 == 0) {
+                    ring.clear();
+                    deque.clear();
+                }
+                break;
+            }
+            EDF_CHECK(sameWindow(ring, deque));
+        }
+    }
+
+    // Unlike BoundedDeque, an oversized append keeps the newest maxSize elements
+    edf::utils::RingBuffer<int> ring{4};
+    ring.append(std::vector<int>{1, 2, 3, 4, 5, 6, 7});
+    EDF_CHECK(ring.toVector() == (std::vector<int>{4, 5, 6, 7}));
+    ring.drop_back(1);
+    EDF_CHECK(ring.toVector() == (std::vector<int>{4, 5, 6}));
+    ring.fill(9);
+    EDF_CHECK(ring.full() && ring.toVector() == (std::vector<int>{9, 9, 9, 9}));
+
+    // reset changes the capacity and empties the window
+    ring.reset(6);
+    EDF_CHECK(ring.empty() && ring.maxSize() == 6 && ring.capacity() == 8);
+    ring.append(std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8});
+    EDF_CHECK(ring.toVector() == (std::vector<int>{3, 4, 5, 6, 7, 8}));
+    ring.reset(2);
+    EDF_CHECK(ring.empty() && ring.capacity() == 2);
+    ring.append(std::vector<int>{1, 2, 3});
+    EDF_CHECK(ring.toVector() == (std::vector<int>{2, 3}));
+
+    // copyWindow pads the front of windows reaching past the oldest element
+    std::vector<int> window(4, -1);
+    ring.copyWindow(window.data(), window.size());
+    EDF_CHECK(window == (std::vector<int>{0, 0, 2, 3}));
+    ring.copyWindow(window.data(), 1, 1);
+    EDF_CHECK(window[0] == 2);
+
+    return edf::test::result();
+}
@@ -0,0 +1,40 @@
+// Times SsdDecoder against the row-by-row decoding it replaced, for detector outputs of one to several screens.
+//
+// Usage: ssd_decode_bench [RUNS]
+
+#include "ssd_reference.h"
+#include "test_support.h"
+
+#include "vision/ssd_decode.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+int main(int argc, char** argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 200;
+    std::mt19937 random{30};
+    edf::vision::SsdDecoder decoder;
+
+    std::printf("%8s %10s %14s %14s %8s\n", "rows", "positive", "reference us", "decoder us", "speedup");
+    for (size_t count : {200, 800, 3200}) {
+        for (float positive : {0.01f, 0.1f}) {
+            const auto rows  = edf::test::randomSsdRows(count, positive, random);
+            size_t sink      = 0;
+            const double ref = edf::test::bestNanoseconds(runs, [&] {
+                sink += edf::test::referenceDecode(rows.data(), count, 0.5f, 0.3f).size();
+            });
+            const double opt = edf::test::bestNanoseconds(runs, [&] {
+                sink += decoder.decode(rows.data(), count, 0.5f, 0.3f).size();
+            });
+            std::printf("%8zu %10.2f %14.2f %14.2f %7.2fx%s\n",
+                        count,
+                        positive,
+                        ref / 1000.0,
+                        opt / 1000.0,
+                        ref / opt,
+                        sink == 0 ? " (nothing kept)" : "");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+// SsdDecoder against the row-by-row reference: same kept boxes in the same order, and no box without area.
+
+#include "ssd_reference.h"
+#include "test_support.h"
+
+#include "vision/ssd_decode.h"
+
+#include <random>
+
+namespace {
+
+bool sameBoxes(const edf::vision::DetectionBoxes& boxes, const std::vector<edf::test::ReferenceBox>& expected) {
+    if (boxes.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        if (boxes.x0[i] != expected[i].x0 || boxes.y0[i] != expected[i].y0 || boxes.x1[i] != expected[i].x1 ||
+            boxes.y1[i] != expected[i].y1 || boxes.score[i] != expected[i].score) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random{30};
+    edf::vision::SsdDecoder decoder;
+
+    for (size_t count : {0, 1, 3, 4, 5, 7, 64, 200, 1000, 4000}) {
+        for (float iou : {0.3f, 0.5f}) {
+            for (size_t maxBoxes : {0, 1, 4}) {
+                const auto rows     = edf::test::randomSsdRows(count, 0.2f, random);
+                const auto expected = edf::test::referenceDecode(rows.data(), count, 0.5f, iou, maxBoxes);
+                const auto& kept    = decoder.decode(rows.data(), count, 0.5f, iou, maxBoxes);
+                EDF_CHECK(sameBoxes(kept, expected));
+            }
+        }
+    }
+
+    // Degenerate boxes never reach suppression, so they cannot take a maxBoxes slot
+    const float rows[] = {
+        0, 1, 0.99f, 0.5f, 0.5f, 0.5f, 0.7f,  // zero width
+        0, 1, 0.98f, 0.6f, 0.2f, 0.4f, 0.4f,  // inverted
+        0, 1, 0.97f, 1.1f, 0.2f, 1.3f, 0.4f,  // outside the image, zero width once clamped
+        0, 1, 0.60f, 0.1f, 0.1f, 0.3f, 0.3f,  // valid
+        0, 1, 0.40f, 0.5f, 0.5f, 0.7f, 0.7f,  // below the threshold
+    };
+    const auto& kept = decoder.decode(rows, 5, 0.5f, 0.5f, 1);
+    EDF_CHECK(kept.size() == 1);
+    EDF_CHECK(!kept.empty() && kept.score[0] == 0.60f);
+
+    return edf::test::result();
+}
@@ -0,0 +1,103 @@
+/**
+ * @file ssd_reference.h
+ * @brief Row-by-row SSD decoding and NMS, the straightforward code `vision::SsdDecoder` replaced.
+ *
+ * Boxes are kept as an array of structures and every call allocates, as before the decoder; the tests use it as the
+ * expected result and the benchmark as the baseline.
+ */
+
+#pragma once
+
+#include "vision/ssd_decode.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace edf::test {
+
+struct ReferenceBox {
+    float x0, y0, x1, y1, score;
+};
+
+inline std::vector<ReferenceBox>
+referenceDecode(const float* rows, size_t count, float threshold, float iouThreshold, size_t maxBoxes = 0) {
+    std::vector<ReferenceBox> candidates;
+    for (size_t i = 0; i < count; ++i) {
+        const float* r = rows + i * vision::SsdDecoder::rowLength;
+        if (r[2] <= threshold) {
+            continue;
+        }
+        auto clamp01 = [](float v) { return std::min(std::max(v, 0.0f), 1.0f); };
+        const ReferenceBox box{clamp01(r[3]), clamp01(r[4]), clamp01(r[5]), clamp01(r[6]), r[2]};
+        if (box.x1 > box.x0 && box.y1 > box.y0) {
+            candidates.push_back(box);
+        }
+    }
+    std::vector<size_t> order(candidates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return candidates[a].score > candidates[b].score;
+    });
+
+    std::vector<ReferenceBox> kept;
+    std::vector<bool> suppressed(candidates.size(), false);
+    for (size_t a = 0; a < order.size(); ++a) {
+        if (suppressed[a]) {
+            continue;
+        }
+        const auto& box = candidates[order[a]];
+        kept.push_back(box);
+        if (maxBoxes != 0 && kept.size() == maxBoxes) {
+            break;
+        }
+        for (size_t b = a + 1; b < order.size(); ++b) {
+            const auto& other  = candidates[order[b]];
+            const float width  = std::max(0.0f, std::min(box.x1, other.x1) - std::max(box.x0, other.x0));
+            const float height = std::max(0.0f, std::min(box.y1, other.y1) - std::max(box.y0, other.y0));
+            const float inter  = width * height;
+            const float area   = (box.x1 - box.x0) * (box.y1 - box.y0) + (other.x1 - other.x0) * (other.y1 - other.y0);
+            if (inter / (area - inter) > iouThreshold) {
+                suppressed[b] = true;
+            }
+        }
+    }
+    return kept;
+}
+
+/**
+ * @brief Detector-like output: `count` rows, about `positiveFraction` of them confident, clustered around a few faces.
+ *
+ * A few rows have inverted, out-of-range or NaN coordinates.
+ */
+template <typename Random> std::vector<float> randomSsdRows(size_t count, float positiveFraction, Random& random) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<float> rows(count * vision::SsdDecoder::rowLength);
+    for (size_t i = 0; i < count; ++i) {
+        float* r        = &rows[i * vision::SsdDecoder::rowLength];
+        const float cx  = 0.1f + 0.2f * static_cast<float>(i % 5) + 0.02f * unit(random);
+        const float cy  = 0.3f + 0.05f * unit(random);
+        const float w   = 0.05f + 0.1f * unit(random);
+        r[0]            = 0.0f;
+        r[1]            = 1.0f;
+        r[2]            = unit(random) < positiveFraction ? 0.5f + 0.5f * unit(random) : 0.3f * unit(random);
+        r[3]            = cx - w;
+        r[4]            = cy - w;
+        r[5]            = cx + w;
+        r[6]            = cy + w;
+        const float odd = unit(random);
+        if (odd < 0.02f) {
+            std::swap(r[3], r[5]); // inverted
+        } else if (odd < 0.04f) {
+            r[3] = 1.2f; // entirely right of the image
+            r[5] = 1.4f;
+        } else if (odd < 0.05f) {
+            r[4] = std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+    return rows;
+}
+
+} // namespace edf::test
@@ -0,0 +1,54 @@
+/**
+ * @file test_support.h
+ * @brief Minimal checks and timing shared by the tests and microbenchmarks; no framework dependency.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace edf::test {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+/// Exit status of a test executable: non-zero when a check failed.
+inline int result() {
+    if (failures() != 0) {
+        std::cerr << failures() << " check(s) failed\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Best wall time of `runs` calls of `body`, in nanoseconds per call.
+ *
+ * The minimum rather than the mean keeps scheduler noise out of the comparison.
+ */
+template <typename Body> double bestNanoseconds(int runs, Body&& body) {
+    double best = 0.0;
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = run == 0 ? elapsed.count() : std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+} // namespace edf::test
+
+/// Records a failure with its location and continues.
+#define EDF_CHECK(condition)                                                                                           \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n";                            \
+            ++edf::test::failures();                                                                                   \
+        }                                                                                                              \
+    } while (false)
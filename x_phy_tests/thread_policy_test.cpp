@@ -0,0 +1,103 @@
+// ThreadPolicy layouts on synthetic topologies, topology discovery on this machine and, on Linux, that pinning
+// really moves a thread onto the processors the policy chose.
+
+#include "test_support.h"
+
+#include "utils/thread_policy.h"
+
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace {
+
+using edf::utils::PhysicalCore;
+using edf::utils::ThreadPolicy;
+
+// `count` cores with two SMT siblings each, numbered like Linux does: core i is {i, i + count}
+std::vector<PhysicalCore> smtCores(int count) {
+    std::vector<PhysicalCore> cores;
+    for (int i = 0; i < count; ++i) {
+        cores.push_back({0, 0, {i, i + count}});
+    }
+    return cores;
+}
+
+std::vector<int> sorted(std::vector<int> cpus) {
+    std::sort(cpus.begin(), cpus.end());
+    return cpus;
+}
+
+// Runs `body` on a fresh thread so the pinning does not stick to the test's main thread
+template <typename Body> void onThread(Body&& body) {
+    std::thread thread{std::forward<Body>(body)};
+    thread.join();
+}
+
+} // namespace
+
+int main() {
+    EDF_CHECK(edf::utils::detail::parseCpuList("0-3,8,10-11\n") == (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EDF_CHECK(edf::utils::detail::parseCpuList("5") == (std::vector<int>{5}));
+    EDF_CHECK(edf::utils::detail::parseCpuList("x,2") == (std::vector<int>{2}));
+
+    // One core with both siblings for capture, inference on the first sibling of every other core
+    const ThreadPolicy laptop{smtCores(4)};
+    EDF_CHECK(laptop.captureProcessors() == (std::vector<int>{0, 4}));
+    EDF_CHECK(laptop.inferenceProcessors() == (std::vector<int>{1, 2, 3}));
+    EDF_CHECK(laptop.inferenceThreads() == 3);
+
+    // Reservations are clamped so inference keeps a core; a single core is shared
+    EDF_CHECK(ThreadPolicy(smtCores(2), 5).inferenceProcessors() == (std::vector<int>{1}));
+    const ThreadPolicy single{smtCores(1)};
+    EDF_CHECK(single.inferenceProcessors() == (std::vector<int>{0}));
+    EDF_CHECK(single.captureProcessors() == (std::vector<int>{0, 1}));
+
+    // Discovery covers exactly the processors this process may run on, each once
+    const auto allowed = sorted(edf::utils::currentThreadAffinity());
+    const auto cores   = edf::utils::discoverPhysicalCores();
+    EDF_CHECK(!cores.empty());
+    std::vector<int> discovered;
+    for (const auto& core : cores) {
+        EDF_CHECK(!core.logicalProcessors.empty());
+        EDF_CHECK(core.group == 0);
+        discovered.insert(discovered.end(), core.logicalProcessors.begin(), core.logicalProcessors.end());
+    }
+    EDF_CHECK(std::set<int>(discovered.begin(), discovered.end()).size() == discovered.size());
+#ifdef __linux__
+    EDF_CHECK(sorted(discovered) == allowed);
+#endif
+
+    const auto policy = ThreadPolicy::detect(1, true);
+    for (size_t index = 0; index < policy.inferenceProcessors().size() + 1; ++index) {
+        onThread([&] {
+            EDF_CHECK(policy.pinInferenceThread(index));
+            const int expected = policy.inferenceProcessors()[index % policy.inferenceProcessors().size()];
+            EDF_CHECK(edf::utils::currentThreadAffinity() == (std::vector<int>{expected}));
+#ifdef __linux__
+            std::this_thread::yield();
+            EDF_CHECK(sched_getcpu() == expected);
+#endif
+        });
+    }
+    onThread([&] {
+        EDF_CHECK(policy.pinCaptureThread());
+        EDF_CHECK(edf::utils::currentThreadAffinity() == sorted(policy.captureProcessors()));
+    });
+
+    // Without pinning the policy only sizes pools and leaves affinities alone
+    const auto unpinned = ThreadPolicy::detect(1, false);
+    onThread([&] {
+        EDF_CHECK(!unpinned.pinInferenceThread(0));
+        EDF_CHECK(!unpinned.pinCaptureThread());
+        EDF_CHECK(sorted(edf::utils::currentThreadAffinity()) == allowed);
+    });
+    EDF_CHECK(sorted(edf::utils::currentThreadAffinity()) == allowed);
+
+    return edf::test::result();
+}
@@ -767,7 +767,8 @@ namespace XPhyWrapper {
             XPhyWrapperNative::SetupVoiceInferenceEnv(static_cast<ApplicationControllerHandle*>(controllerHandle_), mode);
 
             // Create audio capture queue
-            audioCaptureQueue_ = XPhyWrapperNative::CreateAudioCaptureQueue();
+            audioCaptureQueue_ = XPhyWrapperNative::CreateAudioCaptureQueue(
+                static_cast<ApplicationControllerHandle*>(controllerHandle_));
 
             // Set run flags and detection running status
             *audioRun_ = true;
@@ -794,6 +795,9 @@ namespace XPhyWrapper {
             captureParams->queue = audioCaptureQueue_;
             captureParams->run = audioRun_;
             captureParams->captureDurationSecs = captureDurationSecs;
+            // [voice] voiceCaptureChunkMs; the engine scores every voiceHopMs of audio, or every chunk when it is 0
+            captureParams->captureChunkMs = XPhyWrapperNative::GetVoiceCaptureChunkMs(
+                static_cast<ApplicationControllerHandle*>(controllerHandle_));
             *audioCaptureFut_ = std::async(
                 std::launch::async,
                 XPhyWrapperNative::RunAudioCaptureWrapper,
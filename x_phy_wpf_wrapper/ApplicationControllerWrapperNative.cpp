@@ -11,6 +11,7 @@
 #include "desktop/resource.h"  // For LICENSE_KEY_* definitions
 #include "voice/audio_capture.h"  // For AudioCapture
 #include "voice/audio_buffer.h"  // For AudioBuffer
+#include "voice/capture_backpressure.h"  // For AudioCaptureChannel
 #include "readerwriterqueue/readerwriterqueue.h"  // For ReaderWriterQueue
 #include "spdlog/spdlog.h"  // For spdlog::get() to check if logger exists
 #include <filesystem>
@@ -244,6 +245,13 @@ namespace XPhyWrapperNative {
         return std::filesystem::path();
     }
 
+    int GetVoiceCaptureChunkMs(ApplicationControllerHandle* handle) {
+        if (handle && handle->controller && *handle->controller) {
+            return static_cast<int>((*handle->controller)->voiceCaptureChunk().count());
+        }
+        return 0;
+    }
+
     void OpenResultsFolder(const std::filesystem::path& resultsDir) {
         std::wstring resultsDirW = resultsDir.wstring();
         ShellExecuteW(nullptr, L"open", resultsDirW.c_str(), nullptr, nullptr, SW_SHOW);
@@ -260,24 +268,42 @@ namespace XPhyWrapperNative {
         }
     }
 
-    void* CreateAudioCaptureQueue() {
-        return new moodycamel::ReaderWriterQueue<edf::voice::AudioBuffer>(1024);
+    void* CreateAudioCaptureQueue(ApplicationControllerHandle* handle) {
+        // Capture queue plus the return queue of scored buffers whose storage the capture thread reuses
+        auto* channel = new edf::voice::AudioCaptureChannel(1024);
+        if (handle && handle->controller && *handle->controller) {
+            (*handle->controller)->configureVoiceCapture(channel->backpressure);
+        }
+        return channel;
     }
 
     void DestroyAudioCaptureQueue(void* queue) {
         if (queue) {
-            delete static_cast<moodycamel::ReaderWriterQueue<edf::voice::AudioBuffer>*>(queue);
+            auto* channel = static_cast<edf::voice::AudioCaptureChannel*>(queue);
+            auto stats = channel->pool.stats();
+            LOG_DEBUG("Audio buffer pool: {} allocated, {} reused, {} dropped", stats.allocated, stats.reused, stats.dropped);
+            auto queueMetrics = channel->backpressure.metrics();
+            LOG_DEBUG("Audio capture queue: max depth {}, {} dropped, {} coalesced, max staleness {} ms, blocked {} ms",
+                queueMetrics.maxDepth, queueMetrics.dropped, queueMetrics.coalesced,
+                queueMetrics.maxStaleness.count() / 1000, queueMetrics.blocked.count() / 1000);
+            delete channel;
         }
     }
 
-    void RunAudioCapture(void* queue, std::atomic_bool* run, int captureDurationSecs) {
+    void RunAudioCapture(void* queue, std::atomic_bool* run, int captureDurationSecs, int captureChunkMs) {
         if (queue && run) {
-            auto* captureQueue = static_cast<moodycamel::ReaderWriterQueue<edf::voice::AudioBuffer>*>(queue);
+            auto* channel = static_cast<edf::voice::AudioCaptureChannel*>(queue);
             // Implement voiceCapture inline to avoid including win_common.h
             try {
                 edf::voice::AudioCapture audio{edf::voice::AudioType::Stereo};
                 while (*run) {
-                    bool succeeded = captureQueue->enqueue(audio.read(captureDurationSecs));
+                    auto buffer = channel->pool.acquire();
+                    if (captureChunkMs > 0) {
+                        audio.read(std::chrono::milliseconds(captureChunkMs), buffer);
+                    } else {
+                        audio.read(captureDurationSecs, buffer);
+                    }
+                    bool succeeded = channel->backpressure.enqueue(channel->queue, std::move(buffer), *run);
                     if (!succeeded) {
                         *run = false;
                         break;
@@ -293,7 +319,7 @@ namespace XPhyWrapperNative {
     // Helper wrapper functions for async calls (avoiding reference parameter issues)
     void RunAudioCaptureWrapper(AudioCaptureParams* params) {
         if (params) {
-            RunAudioCapture(params->queue, params->run, params->captureDurationSecs);
+            RunAudioCapture(params->queue, params->run, params->captureDurationSecs, params->captureChunkMs);
             delete params;  // Clean up params after use
         }
     }
@@ -330,7 +356,7 @@ namespace XPhyWrapperNative {
         void* callbackData) {
         
         if (handle && handle->controller && *handle->controller && captureQueue && run) {
-            auto* queue = static_cast<moodycamel::ReaderWriterQueue<edf::voice::AudioBuffer>*>(captureQueue);
+            auto* channel = static_cast<edf::voice::AudioCaptureChannel*>(captureQueue);
             
             // Create callback wrapper that bridges to managed code
             auto callbackWrapper = [resultCallback, classificationCallback, graphScoreCallback, callbackData](
@@ -379,7 +405,7 @@ namespace XPhyWrapperNative {
             };
             
             (*handle->controller)->runVoiceDetection(*run, mode, isBackgroundRun, sessionDurationSecs, 
-                captureDurationSecs, *queue, callbackWrapper);
+                captureDurationSecs, channel->queue, callbackWrapper, &channel->pool, &channel->backpressure);
         }
     }
 
@@ -69,15 +69,16 @@ namespace XPhyWrapperNative {
         void* callbackData);
     
     // Audio detection functions
-    void* CreateAudioCaptureQueue();
+    void* CreateAudioCaptureQueue(ApplicationControllerHandle* handle);
     void DestroyAudioCaptureQueue(void* queue);
-    void RunAudioCapture(void* queue, std::atomic_bool* run, int captureDurationSecs);
+    void RunAudioCapture(void* queue, std::atomic_bool* run, int captureDurationSecs, int captureChunkMs = 0);
     
     // Helper structures and wrapper functions for async calls
     struct AudioCaptureParams {
         void* queue;
         std::atomic_bool* run;
         int captureDurationSecs;
+        int captureChunkMs = 0; // streaming chunk length; 0 captures whole captureDurationSecs windows
     };
     void RunAudioCaptureWrapper(AudioCaptureParams* params);
     
@@ -112,6 +113,7 @@ namespace XPhyWrapperNative {
     void ClearEnvironment(ApplicationControllerHandle* handle);
     void ClearVoiceEnvironment(ApplicationControllerHandle* handle);
     std::filesystem::path GetResultsDir(ApplicationControllerHandle* handle);
+    int GetVoiceCaptureChunkMs(ApplicationControllerHandle* handle);
     void OpenResultsFolder(const std::filesystem::path& resultsDir);
 
 }